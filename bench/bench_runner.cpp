@@ -0,0 +1,562 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compiles every benchmark translation unit from a manifest, records the wall time and the peak
+// memory of the compiler, and compares the measurements against a checked in baseline; the run
+// fails when a case regressed, cases that are not in the baseline yet are only reported
+//
+// usage: metacheck_bench_runner --compiler <cxx> --flags <file> --manifest <file>
+//                               --baseline <file> --object-dir <dir> [--output <file>]
+//                               [--repeat <n>] [--tolerance <percent>] [--pch <header>]
+//                               [--update]
+//        metacheck_bench_runner --compiler <cxx> --flags <file> --complexity <file>
+//                               --object-dir <dir> [--repeat <n>]
+//        metacheck_bench_runner --compiler <cxx> --flags <file> --compare <file>
+//                               --object-dir <dir> [--repeat <n>]
+//
+// with --pch the header is precompiled once, and every case is compiled a second time with it as
+// "<case>+pch", to show what the precompiled header saves per translation unit
+//
+// with --complexity every series of the manifest compiles a metafunction at a number of list
+// sizes, each next to a control translation unit that only generates the same lists. the cost of
+// the metafunction is the difference, and the exponent k of cost = c * size^k is fitted to it;
+// the run fails when the exponent of the compile time of a series exceeds the bound of the series
+//
+// with --compare every pair of the manifest compiles two implementations of a metafunction at a
+// number of list sizes, each next to the same control, and prints what each costs over the control
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+	struct measurement {
+		double wall_ms;
+		long rss_kb;
+	};
+
+	struct bench_case {
+		std::string name;
+		std::string source;
+	};
+
+	/// a size of a complexity series, with the translation unit of the metafunction and its
+	/// control
+	struct complexity_case {
+		std::string series;
+		double bound;
+		unsigned size;
+		std::string source, control;
+	};
+
+	/// a size of a comparison of two implementations of a metafunction
+	struct compare_case {
+		std::string name;
+		unsigned size;
+		std::string control, first, first_source, second, second_source;
+	};
+
+	struct options {
+		std::string compiler, flags, manifest, baseline, object_dir, output, pch, complexity,
+		        compare;
+		unsigned repeat  = 1;
+		double tolerance = 25;
+		bool update      = false;
+	};
+
+	std::vector<std::string> read_lines(const std::string &path) {
+		std::vector<std::string> lines;
+		std::ifstream file{path};
+		std::string line;
+		while (std::getline(file, line)) {
+			if (!line.empty()) {
+				lines.push_back(line);
+			}
+		}
+		return lines;
+	}
+
+	/// run the compiler once, returns false if it could not be started or did not succeed
+	bool compile(const std::vector<std::string> &args, measurement &result) {
+		std::vector<char *> argv;
+		for (auto &arg : args) {
+			argv.push_back(const_cast<char *>(arg.c_str()));
+		}
+		argv.push_back(nullptr);
+
+		auto start = std::chrono::steady_clock::now();
+		pid_t pid  = fork();
+		if (pid == 0) {
+			execvp(argv[0], argv.data());
+			std::_Exit(127);
+		} else if (pid < 0) {
+			return false;
+		}
+
+		int status;
+		struct rusage usage;
+		if (wait4(pid, &status, 0, &usage) != pid) {
+			return false;
+		}
+		std::chrono::duration<double, std::milli> elapsed =
+		        std::chrono::steady_clock::now() - start;
+
+		result.wall_ms = elapsed.count();
+#ifdef __APPLE__
+		result.rss_kb = usage.ru_maxrss / 1024; // reported in bytes
+#else
+		result.rss_kb = usage.ru_maxrss; // reported in kilobytes
+#endif
+		return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+
+	/// compile repeatedly, keeping the fastest run and the smallest footprint to filter out
+	/// scheduling noise
+	bool compile_best(const std::vector<std::string> &args, unsigned repeat, measurement &best) {
+		for (unsigned run = 0; run < repeat; ++run) {
+			measurement m;
+			if (!compile(args, m)) {
+				return false;
+			}
+			if (run == 0 || m.wall_ms < best.wall_ms) {
+				best.wall_ms = m.wall_ms;
+			}
+			if (run == 0 || m.rss_kb < best.rss_kb) {
+				best.rss_kb = m.rss_kb;
+			}
+		}
+		return true;
+	}
+
+	/// precompile the header for the gcc style -include of the returned header, which includes it
+	bool precompile(const options &opts, const std::vector<std::string> &flags,
+	                std::string &include, measurement &result) {
+		include = opts.object_dir + "/metacheck_pch.hpp";
+		std::ofstream{include} << "#include \"" << opts.pch << "\"" << std::endl;
+		std::vector<std::string> args{opts.compiler};
+		args.insert(args.end(), flags.begin(), flags.end());
+		args.insert(args.end(), {"-x", "c++-header", include, "-o", include + ".gch"});
+		return compile_best(args, opts.repeat, result);
+	}
+
+	/// print the measurement of a case and compare it to the baseline, returns true when it
+	/// regressed; a case that is not in the baseline is counted in missing
+	bool report(const std::string &name, const measurement &best,
+	            const std::map<std::string, measurement> &baseline, double tolerance,
+	            unsigned &missing) {
+		std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+		          << std::setprecision(1) << std::setw(12) << best.wall_ms;
+		auto base = baseline.find(name);
+		if (base == baseline.end()) {
+			std::cout << std::setw(12) << "-" << std::setw(12) << best.rss_kb << std::setw(12)
+			          << "-" << "  (not in baseline)" << std::endl;
+			++missing;
+			return false;
+		}
+		double limit = 1 + tolerance / 100;
+		bool slower  = best.wall_ms > base->second.wall_ms * limit;
+		bool larger  = best.rss_kb > base->second.rss_kb * limit;
+		std::cout << std::setw(12) << base->second.wall_ms << std::setw(12) << best.rss_kb
+		          << std::setw(12) << base->second.rss_kb;
+		if (slower || larger) {
+			std::cout << "  REGRESSION" << (slower ? " (time)" : "")
+			          << (larger ? " (memory)" : "");
+		}
+		std::cout << std::endl;
+		return slower || larger;
+	}
+
+	std::map<std::string, measurement> read_baseline(const std::string &path) {
+		std::map<std::string, measurement> baseline;
+		for (auto &line : read_lines(path)) {
+			if (line[0] == '#') {
+				continue;
+			}
+			std::istringstream row{line};
+			std::string name;
+			measurement m;
+			char sep;
+			if (std::getline(row, name, ',') && row >> m.wall_ms >> sep >> m.rss_kb) {
+				baseline[name] = m;
+			}
+		}
+		return baseline;
+	}
+
+	void write_results(const std::string &path, const std::vector<bench_case> &cases,
+	                   const std::vector<measurement> &results, const std::string &comment = "") {
+		std::ofstream file{path};
+		file << "# name,wall_ms,rss_kb" << std::endl << comment;
+		for (std::size_t i = 0; i < cases.size(); ++i) {
+			file << cases[i].name << "," << std::fixed << std::setprecision(1)
+			     << results[i].wall_ms << "," << results[i].rss_kb << std::endl;
+		}
+	}
+
+	bool parse_args(int argc, char **argv, options &opts) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--update") {
+				opts.update = true;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				std::cerr << "missing value for " << arg << std::endl;
+				return false;
+			}
+			std::string value = argv[++i];
+			if (arg == "--compiler") {
+				opts.compiler = value;
+			} else if (arg == "--flags") {
+				opts.flags = value;
+			} else if (arg == "--manifest") {
+				opts.manifest = value;
+			} else if (arg == "--baseline") {
+				opts.baseline = value;
+			} else if (arg == "--object-dir") {
+				opts.object_dir = value;
+			} else if (arg == "--output") {
+				opts.output = value;
+			} else if (arg == "--repeat") {
+				opts.repeat = std::max(1, std::atoi(value.c_str()));
+			} else if (arg == "--tolerance") {
+				opts.tolerance = std::atof(value.c_str());
+			} else if (arg == "--pch") {
+				opts.pch = value;
+			} else if (arg == "--complexity") {
+				opts.complexity = value;
+			} else if (arg == "--compare") {
+				opts.compare = value;
+			} else {
+				std::cerr << "unknown argument " << arg << std::endl;
+				return false;
+			}
+		}
+		if (!opts.complexity.empty() || !opts.compare.empty()) {
+			return !opts.compiler.empty() && !opts.object_dir.empty();
+		}
+		return !opts.compiler.empty() && !opts.manifest.empty() && !opts.baseline.empty() &&
+		       !opts.object_dir.empty();
+	}
+
+	/// compile a single source of a complexity series or a comparison
+	bool compile_source(const options &opts, const std::vector<std::string> &flags,
+	                    const std::string &source, measurement &best) {
+		std::vector<std::string> args{opts.compiler};
+		args.insert(args.end(), flags.begin(), flags.end());
+		args.insert(args.end(), {"-c", source, "-o", opts.object_dir + "/complexity.o"});
+		if (!compile_best(args, opts.repeat, best)) {
+			std::cerr << "failed to compile " << source << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/// the exponent k of the least squares fit of cost = c * size^k, over the sizes of which the
+	/// cost is larger than the noise of its control; false when fewer than two sizes are above
+	/// the noise
+	bool fit_exponent(const std::vector<double> &sizes, const std::vector<double> &costs,
+	                    const std::vector<double> &noise, double &exponent) {
+		double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+		for (std::size_t i = 0; i < sizes.size(); ++i) {
+			if (costs[i] <= noise[i]) {
+				continue;
+			}
+			double x = std::log(sizes[i]), y = std::log(costs[i]);
+			n += 1;
+			sx += x;
+			sy += y;
+			sxx += x * x;
+			sxy += x * y;
+		}
+		double spread = n * sxx - sx * sx;
+		exponent      = spread > 0 ? (n * sxy - sx * sy) / spread : 0;
+		return n >= 2 && spread > 0;
+	}
+
+	/// print an exponent, and whether it exceeds the bound; returns true when it does
+	bool report_exponent(const char *what, bool fitted, double exponent, double bound) {
+		std::cout << what;
+		if (!fitted) {
+			std::cout << " too small to fit";
+			return false;
+		}
+		std::cout << std::setprecision(2) << " exponent " << exponent;
+		if (exponent > bound) {
+			std::cout << " EXCEEDED";
+		}
+		return exponent > bound;
+	}
+
+	std::vector<complexity_case> read_complexity(const std::string &path) {
+		std::vector<complexity_case> cases;
+		for (auto &line : read_lines(path)) {
+			std::istringstream row{line};
+			complexity_case c;
+			std::string bound, size;
+			if (std::getline(row, c.series, '\t') && std::getline(row, bound, '\t') &&
+			    std::getline(row, size, '\t') && std::getline(row, c.source, '\t') &&
+			    std::getline(row, c.control)) {
+				c.bound = std::atof(bound.c_str());
+				c.size  = unsigned(std::atoi(size.c_str()));
+				cases.push_back(c);
+			}
+		}
+		return cases;
+	}
+
+	/// compile every series of the complexity manifest and check the exponents against their
+	/// bounds, returns the exit code
+	int run_complexity(const options &opts, const std::vector<std::string> &flags) {
+		std::vector<complexity_case> cases = read_complexity(opts.complexity);
+		bool failed                        = false;
+		for (std::size_t begin = 0, end; begin < cases.size(); begin = end) {
+			const std::string &series = cases[begin].series;
+			for (end = begin; end < cases.size() && cases[end].series == series; ++end) {
+			}
+			std::cout << series << std::endl
+			          << std::setw(8) << "size" << std::setw(12) << "wall ms" << std::setw(12)
+			          << "control ms" << std::setw(12) << "rss KB" << std::setw(12)
+			          << "control KB" << std::endl;
+
+			std::vector<double> sizes, times, memory, time_noise, memory_noise;
+			for (std::size_t i = begin; i < end; ++i) {
+				const complexity_case &c = cases[i];
+				measurement m[2];
+				if (!compile_source(opts, flags, c.source, m[0]) ||
+				    !compile_source(opts, flags, c.control, m[1])) {
+					return 1;
+				}
+				std::cout << std::setw(8) << c.size << std::fixed << std::setprecision(1)
+				          << std::setw(12) << m[0].wall_ms << std::setw(12) << m[1].wall_ms
+				          << std::setw(12) << m[0].rss_kb << std::setw(12) << m[1].rss_kb
+				          << std::endl;
+				sizes.push_back(c.size);
+				times.push_back(m[0].wall_ms - m[1].wall_ms);
+				memory.push_back(double(m[0].rss_kb - m[1].rss_kb));
+				// differences within a tenth of the control are noise
+				time_noise.push_back(m[1].wall_ms / 10);
+				memory_noise.push_back(double(m[1].rss_kb) / 10);
+			}
+
+			double bound = cases[begin].bound, time_exponent, memory_exponent;
+			bool time_fitted   = fit_exponent(sizes, times, time_noise, time_exponent);
+			bool memory_fitted = fit_exponent(sizes, memory, memory_noise, memory_exponent);
+			std::cout << std::setprecision(2) << "bound " << bound << ", ";
+			bool exceeded = report_exponent("time", time_fitted, time_exponent, bound);
+			std::cout << ", ";
+			exceeded = report_exponent("memory", memory_fitted, memory_exponent, bound) || exceeded;
+			std::cout << std::endl << std::endl;
+			failed = failed || exceeded;
+		}
+		if (failed) {
+			std::cout << "the compile cost of a metafunction grows faster than its bound"
+			          << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	std::vector<compare_case> read_compare(const std::string &path) {
+		std::vector<compare_case> cases;
+		for (auto &line : read_lines(path)) {
+			std::istringstream row{line};
+			compare_case c;
+			std::string size;
+			if (std::getline(row, c.name, '\t') && std::getline(row, size, '\t') &&
+			    std::getline(row, c.control, '\t') && std::getline(row, c.first, '\t') &&
+			    std::getline(row, c.first_source, '\t') && std::getline(row, c.second, '\t') &&
+			    std::getline(row, c.second_source)) {
+				c.size = unsigned(std::atoi(size.c_str()));
+				cases.push_back(c);
+			}
+		}
+		return cases;
+	}
+
+	/// the cost of the second implementation as a percentage of the first one
+	double percentage(double second, double first) {
+		return first > 0 ? second / first * 100 : 0;
+	}
+
+	/// compile both implementations of every comparison of the manifest, and print their costs
+	/// over the control; returns the exit code
+	int run_compare(const options &opts, const std::vector<std::string> &flags) {
+		std::vector<compare_case> cases = read_compare(opts.compare);
+		for (std::size_t begin = 0, end; begin < cases.size(); begin = end) {
+			const compare_case &pair = cases[begin];
+			for (end = begin; end < cases.size() && cases[end].name == pair.name; ++end) {
+			}
+			std::cout << pair.name << ": " << pair.first << " (1) against " << pair.second
+			          << " (2), cost over the control" << std::endl
+			          << std::setw(8) << "size" << std::setw(12) << "1 ms" << std::setw(12)
+			          << "2 ms" << std::setw(12) << "1 KB" << std::setw(12) << "2 KB"
+			          << std::endl;
+
+			// the costs summed over all sizes, negative differences are noise
+			double first_ms = 0, second_ms = 0, first_kb = 0, second_kb = 0;
+			for (std::size_t i = begin; i < end; ++i) {
+				const compare_case &c = cases[i];
+				measurement control, first, second;
+				if (!compile_source(opts, flags, c.control, control) ||
+				    !compile_source(opts, flags, c.first_source, first) ||
+				    !compile_source(opts, flags, c.second_source, second)) {
+					return 1;
+				}
+				double costs[] = {std::max(first.wall_ms - control.wall_ms, 0.0),
+				                  std::max(second.wall_ms - control.wall_ms, 0.0),
+				                  std::max(double(first.rss_kb - control.rss_kb), 0.0),
+				                  std::max(double(second.rss_kb - control.rss_kb), 0.0)};
+				std::cout << std::setw(8) << c.size << std::fixed << std::setprecision(1);
+				for (double cost : costs) {
+					std::cout << std::setw(12) << cost;
+				}
+				std::cout << std::endl;
+				first_ms += costs[0];
+				second_ms += costs[1];
+				first_kb += costs[2];
+				second_kb += costs[3];
+			}
+			std::cout << std::setprecision(0) << pair.second << " takes "
+			          << percentage(second_ms, first_ms) << "% of the compile time and "
+			          << percentage(second_kb, first_kb) << "% of the memory of " << pair.first
+			          << std::endl
+			          << std::endl;
+		}
+		return 0;
+	}
+} // namespace
+
+int main(int argc, char **argv) {
+	options opts;
+	if (!parse_args(argc, argv, opts)) {
+		std::cerr << "usage: " << argv[0]
+		          << " --compiler <cxx> --flags <file> --manifest <file> --baseline <file>"
+		             " --object-dir <dir> [--output <file>] [--repeat <n>]"
+		             " [--tolerance <percent>] [--pch <header>] [--update]"
+		          << std::endl
+		          << "       " << argv[0]
+		          << " --compiler <cxx> --flags <file> --complexity <file> --object-dir <dir>"
+		             " [--repeat <n>]"
+		          << std::endl
+		          << "       " << argv[0]
+		          << " --compiler <cxx> --flags <file> --compare <file> --object-dir <dir>"
+		             " [--repeat <n>]"
+		          << std::endl;
+		return 2;
+	}
+
+	std::vector<std::string> flags = read_lines(opts.flags);
+	if (!opts.complexity.empty()) {
+		return run_complexity(opts, flags);
+	}
+	if (!opts.compare.empty()) {
+		return run_compare(opts, flags);
+	}
+	std::vector<bench_case> cases;
+	for (auto &line : read_lines(opts.manifest)) {
+		auto tab = line.find('\t');
+		cases.push_back({line.substr(0, tab), line.substr(tab + 1)});
+	}
+
+	auto baseline = read_baseline(opts.baseline);
+	std::vector<measurement> results;
+	bool failed      = false;
+	unsigned missing = 0;
+
+	std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(12) << "wall ms"
+	          << std::setw(12) << "base ms" << std::setw(12) << "rss KB" << std::setw(12)
+	          << "base KB" << std::endl;
+	std::string pch_include;
+	if (!opts.pch.empty()) {
+		measurement m;
+		if (!precompile(opts, flags, pch_include, m)) {
+			std::cerr << "failed to precompile " << opts.pch << std::endl;
+			return 1;
+		}
+		std::cout << "precompiled " << opts.pch << " in " << std::fixed << std::setprecision(1)
+		          << m.wall_ms << " ms" << std::endl;
+	}
+
+	std::vector<bench_case> measured;
+	double total_saved = 0;
+	for (auto &c : cases) {
+		std::vector<std::string> args{opts.compiler};
+		args.insert(args.end(), flags.begin(), flags.end());
+		args.insert(args.end(), {"-c", c.source, "-o", opts.object_dir + "/" + c.name + ".o"});
+
+		measurement best{0, 0};
+		if (!compile_best(args, opts.repeat, best)) {
+			std::cerr << "failed to compile benchmark case " << c.name << std::endl;
+			return 1;
+		}
+		measured.push_back(c);
+		results.push_back(best);
+		failed = report(c.name, best, baseline, opts.tolerance, missing) || failed;
+
+		if (pch_include.empty()) {
+			continue;
+		}
+		// the same case, with the precompiled header included before anything else
+		args.insert(args.begin() + 1, {"-include", pch_include});
+		args.back() = opts.object_dir + "/" + c.name + "+pch.o";
+		measurement with_pch{0, 0};
+		if (!compile_best(args, opts.repeat, with_pch)) {
+			std::cerr << "failed to compile benchmark case " << c.name << " with "
+			          << opts.pch << std::endl;
+			return 1;
+		}
+		measured.push_back({c.name + "+pch", c.source});
+		results.push_back(with_pch);
+		failed = report(c.name + "+pch", with_pch, baseline, opts.tolerance, missing) || failed;
+		total_saved += best.wall_ms - with_pch.wall_ms;
+	}
+	if (!pch_include.empty() && !cases.empty()) {
+		std::cout << "the precompiled header saves " << std::fixed << std::setprecision(1)
+		          << total_saved / cases.size() << " ms per translation unit on average"
+		          << std::endl;
+	}
+
+	if (!opts.output.empty()) {
+		write_results(opts.output, measured, results);
+	}
+	if (opts.update) {
+		// timings only compare on the same machine, so the baseline names what recorded it
+		write_results(opts.baseline, measured, results,
+		              "# recorded with " + opts.compiler +
+		                      " by the metacheck_bench_update target; record it again on the\n"
+		                      "# machine that runs the gate\n");
+		std::cout << "baseline written to " << opts.baseline << std::endl;
+		return 0;
+	}
+	if (missing > 0) {
+		// a new case, or a baseline recorded on another machine, should not fail the build, but
+		// it does leave the case unguarded
+		std::cout << "warning: " << missing << " of " << measured.size() << " cases are not in "
+		          << opts.baseline << " and were not compared; build the metacheck_bench_update"
+		             " target to record them"
+		          << std::endl;
+	}
+	if (failed) {
+		std::cout << "compile time regressed by more than " << opts.tolerance
+		          << "% against the baseline; build the metacheck_bench_update target to record a"
+		             " new baseline"
+		          << std::endl;
+		return 1;
+	}
+	return 0;
+}
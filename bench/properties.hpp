@@ -0,0 +1,50 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// properties and generators shared by the generated benchmark translation units
+#pragma once
+
+#include "../src/metacheck.hpp"
+
+namespace bench {
+	namespace kmpl = kvasir::mpl;
+
+	/// generator for a list length that is always exactly N
+	template <unsigned N>
+	using length = mc::gen::just<kmpl::uint_<N>>;
+
+	/// lists nested depth times, every level having exactly len elements
+	template <unsigned depth, unsigned len>
+	struct nested_impl {
+		using f = mc::gen::list_of<typename nested_impl<depth - 1, len>::f, length<len>>;
+	};
+	template <unsigned len>
+	struct nested_impl<0, len> {
+		using f = mc::gen::uint_<>;
+	};
+	template <unsigned depth, unsigned len>
+	using nested = typename nested_impl<depth, len>::f;
+
+	/// always passes, so every try is generated and evaluated
+	template <typename...>
+	using pass = std::true_type;
+
+	/// instantiates F with the parameters and always passes, to measure the cost of F alone
+	template <template <typename...> class F>
+	struct evaluates {
+		template <typename... Ts>
+		struct f {
+			constexpr static bool value = sizeof(mc::mpl::call<F, kmpl::list<Ts...>>) != 0;
+		};
+	};
+
+	/// fails for every list with more than one element, so the whole list has to be minified
+	template <typename L>
+	struct shorter_than_2;
+	template <template <typename...> class Seq, typename... Ts>
+	struct shorter_than_2<Seq<Ts...>> {
+		constexpr static bool value = sizeof...(Ts) < 2;
+	};
+} // namespace bench
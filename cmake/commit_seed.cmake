@@ -0,0 +1,23 @@
+# writes the seed of the commit seed policy to OUTPUT: the start of the hash of the commit that is
+# checked out in SOURCE_DIR; the header is only written when the seed changed, so the tests are
+# not rebuilt when the commit stays the same
+
+execute_process(COMMAND git rev-parse HEAD
+		WORKING_DIRECTORY ${SOURCE_DIR}
+		OUTPUT_VARIABLE COMMIT
+		OUTPUT_STRIP_TRAILING_WHITESPACE
+		RESULT_VARIABLE RESULT
+		ERROR_QUIET)
+if (NOT RESULT EQUAL 0 OR COMMIT STREQUAL "")
+	set(COMMIT 0000000000000000)
+endif ()
+string(SUBSTRING ${COMMIT} 0 16 SEED)
+
+set(CONTENTS "#define METACHECK_RANDOM 0x${SEED}ull\n")
+set(OLD_CONTENTS "")
+if (EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} OLD_CONTENTS)
+endif ()
+if (NOT CONTENTS STREQUAL OLD_CONTENTS)
+	file(WRITE ${OUTPUT} "${CONTENTS}")
+endif ()
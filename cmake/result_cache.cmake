@@ -0,0 +1,42 @@
+# looks up a test translation unit in the result cache and writes the source that is compiled in
+# its place to OUTPUT:
+# - on a hit, a cached_section with the stored result, defining and registering SYMBOL like
+#   SOURCE would
+# - on a miss, SOURCE itself with its key defined, so the test runner stores its result
+#
+# the key is a hash of the compiler and the preprocessed SOURCE, which includes the seed; OUTPUT is
+# only written when it changes, so nothing is rebuilt for nothing
+
+file(STRINGS ${FLAGS} FLAG_LIST)
+execute_process(COMMAND ${CXX} ${FLAG_LIST} -E ${SOURCE}
+		OUTPUT_VARIABLE PREPROCESSED
+		RESULT_VARIABLE RESULT)
+if (NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "could not preprocess ${SOURCE}")
+endif ()
+string(SHA256 KEY "${COMPILER}\n${PREPROCESSED}")
+
+if (EXISTS ${CACHE_DIR}/${KEY}.hpp)
+	set(CONTENTS "// the cached result of ${SOURCE}
+#include \"${METACHECK_HEADER}\"
+
+constexpr mc::detail::cached_section metacheck_cached_section{
+#include \"${CACHE_DIR}/${KEY}.hpp\"
+};
+const mc::detail::section_base *${SYMBOL} = &metacheck_cached_section;
+METACHECK_REGISTER(metacheck_cached_section);
+")
+else ()
+	set(CONTENTS "// ${SOURCE}, of which the result is stored in the cache by the test runner
+#define METACHECK_CACHE_KEY \"${KEY}\"
+#include \"${SOURCE}\"
+")
+endif ()
+
+set(OLD_CONTENTS "")
+if (EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} OLD_CONTENTS)
+endif ()
+if (NOT CONTENTS STREQUAL OLD_CONTENTS)
+	file(WRITE ${OUTPUT} "${CONTENTS}")
+endif ()
@@ -5,9 +5,12 @@
 
 #include <iostream>
 
+#include "src/runner.hpp"
 #include "test/test.hpp"
 
 int main() {
-	std::cout << mc::test_all(test_section, test_section_base);
+	auto result = mc::test_all(test_section, mc::registered_sections);
+	std::cout << result;
+	mc::record_results(result);
 	return 0;
 }
@@ -0,0 +1,314 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// run time benchmarks over generated types: every try of a benchmark generates its parameters
+// like the tries of a test, and instead of calling a property, the call operator of Body with the
+// generated types is timed:
+//
+//   template <typename List>
+//   struct copy_tuples;
+//   template <typename... Ts>
+//   struct copy_tuples<kvasir::mpl::list<Ts...>> {
+//       std::size_t operator()() const;
+//   };
+//
+//   std::cout << mc::run_benchmarks(mc::section("tuples",
+//           mc::benchmark<copy_tuples, 50, mc::gen::list_of<mc::gen::any<...>>>));
+//
+// the cases are generated while compiling, with the seed of the benchmark, so a build times the
+// same types every run. every case is run a few times to warm up and then timed a number of times
+// (see the warmup and repetitions options in config.hpp), and the cases with the slowest median
+// are reported with the names of their types. a result returned by Body is kept, so the compiler
+// does not optimize the work away
+//
+// include it in the single translation unit of the runner, like runner.hpp; the tests in the
+// sections are left out
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "runner.hpp"
+
+namespace mc {
+	namespace detail {
+		template <typename Config, template <typename...> class Body, unsigned tries,
+		          typename... Params>
+		struct benchmark {
+			static_assert(tries > 0, "a benchmark takes at least one try");
+		};
+
+		/// keep the compiler from optimizing away a value that is never used
+		template <typename T>
+		void keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+			asm volatile("" : : "r,m"(value) : "memory");
+#else
+			static const volatile void *sink;
+			sink = &value;
+#endif
+		}
+
+		template <typename Body>
+		void run_body(std::true_type) {
+			Body{}();
+		}
+		template <typename Body>
+		void run_body(std::false_type) {
+			keep(Body{}());
+		}
+
+		/// the median and the fastest of the timed runs of a case, in nanoseconds
+		struct case_time {
+			double median, fastest;
+		};
+
+		template <typename Config, typename Body>
+		case_time time_case() {
+			using returns_void = std::is_void<decltype(std::declval<const Body &>()())>;
+			for (unsigned i = 0; i < Config::warmup; ++i) {
+				run_body<Body>(returns_void{});
+			}
+			std::vector<double> times(Config::repetitions == 0 ? 1 : Config::repetitions);
+			for (double &time : times) {
+				auto start = std::chrono::steady_clock::now();
+				run_body<Body>(returns_void{});
+				time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+				                                                 start)
+				               .count();
+			}
+			std::sort(times.begin(), times.end());
+			return {times[times.size() / 2], times.front()};
+		}
+
+		/// a generated case of a benchmark: the names of its types, and how to time it
+		struct bench_case {
+			const string_part *params;
+			unsigned num_params;
+			case_time (*time)();
+		};
+
+		template <typename Config, template <typename...> class Body, typename Params>
+		struct make_case;
+		template <typename Config, template <typename...> class Body, typename... Params>
+		struct make_case<Config, Body, gen::value::list<Params...>> {
+			constexpr static bench_case value = {type_names<typename Params::type...>::value,
+			                                     sizeof...(Params),
+			                                     &time_case<Config, Body<typename Params::type...>>};
+		};
+		template <typename Config, template <typename...> class Body, typename... Params>
+		constexpr bench_case make_case<Config, Body, gen::value::list<Params...>>::value;
+
+		/// the cases of all the tries of a benchmark, generated in a single pack expansion like
+		/// the tries of a test
+		template <typename Config, template <typename...> class Body, unsigned tries,
+		          typename seed, typename Tries, typename... Params>
+		struct bench_cases;
+		template <typename Config, template <typename...> class Body, unsigned tries,
+		          typename seed, std::size_t... Tries, typename... Params>
+		struct bench_cases<Config, Body, tries, seed, std::index_sequence<Tries...>, Params...> {
+			template <std::size_t try_num>
+			using generated = call_generated<Body, try_seed<Config, seed, try_num, tries>,
+			                                 Params...>;
+
+			constexpr static bench_case value[] = {
+			        make_case<Config, Body, typename generated<Tries>::parameters>::value...};
+
+			using summary = make_summary<tries, sum({generated<Tries>::hits...}),
+			                             tries_stats<parameter_stats<
+			                                     typename generated<Tries>::parameters>...>>;
+		};
+		template <typename Config, template <typename...> class Body, unsigned tries,
+		          typename seed, std::size_t... Tries, typename... Params>
+		constexpr bench_case bench_cases<Config, Body, tries, seed, std::index_sequence<Tries...>,
+		                                 Params...>::value[];
+
+		/// the timings of the cases of a benchmark
+		struct bench_result {
+			string_part name;
+			unsigned warmup, repetitions, slowest;
+			try_record summary;
+			const bench_case *cases;
+			std::vector<case_time> times;
+			double seconds;
+		};
+
+		template <typename Config, template <typename...> class Body, unsigned tries,
+		          typename... Params>
+		bench_result run_benchmark() {
+			using cases = bench_cases<Config, Body, tries,
+			                          test_seed<benchmark<Config, Body, tries, Params...>>,
+			                          std::make_index_sequence<tries>, Params...>;
+			bench_result result{test_name<Body>(),
+			                    Config::warmup,
+			                    Config::repetitions,
+			                    Config::slowest,
+			                    cases::summary::record(),
+			                    cases::value,
+			                    {},
+			                    0};
+			auto start = std::chrono::steady_clock::now();
+			for (const bench_case &c : cases::value) {
+				result.times.push_back(c.time());
+			}
+			result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+			                         .count();
+			return result;
+		}
+
+		inline std::ostream &print_benchmark(std::ostream &stream, const std::string &suite,
+		                                     const bench_result &bench) {
+			auto ms = uint64_t(bench.seconds * 1000);
+			stream << "[ RUN      ] " << suite << bench.name << std::endl;
+			print_tries(stream, bench.summary);
+
+			// the cases from slowest to fastest
+			std::vector<unsigned> order(bench.times.size());
+			for (unsigned i = 0; i < order.size(); ++i) {
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+				return bench.times[a].median > bench.times[b].median;
+			});
+			stream << "Timed " << order.size() << (order.size() == 1 ? " case" : " cases")
+			       << " after " << bench.warmup << " warm-up runs, median of " << bench.repetitions
+			       << " runs (min/median/max): " << uint64_t(bench.times[order.back()].median)
+			       << "/" << uint64_t(bench.times[order[order.size() / 2]].median) << "/"
+			       << uint64_t(bench.times[order.front()].median) << " ns" << std::endl
+			       << "Slowest (median ns, fastest ns, types):";
+			for (unsigned i = 0; i < order.size() && i < bench.slowest; ++i) {
+				const bench_case &c = bench.cases[order[i]];
+				stream << "\n\t" << uint64_t(bench.times[order[i]].median) << "\t"
+				       << uint64_t(bench.times[order[i]].fastest) << "\t";
+				for (unsigned param = 0; param < c.num_params; ++param) {
+					stream << (param == 0 ? "" : ", ") << c.params[param];
+				}
+			}
+			stream << std::endl
+			       << "[       OK ] " << suite << bench.name << " (" << ms << " ms)" << std::endl;
+			return stream;
+		}
+
+		/// the benchmarks of a section
+		struct bench_section {
+			std::string name;
+			std::vector<bench_result> benchmarks;
+			std::vector<bench_section> sections;
+
+			unsigned num_benchmarks() const {
+				unsigned count = unsigned(benchmarks.size());
+				for (const bench_section &section : sections) {
+					count += section.num_benchmarks();
+				}
+				return count;
+			}
+		};
+
+		template <uint64_t patterns>
+		struct bench_items {
+			bench_section &section;
+
+			template <typename Config, template <typename...> class Body, unsigned tries,
+			          typename... Params>
+			void operator()(const benchmark<Config, Body, tries, Params...>) {
+				if (selected<Body>(patterns)) {
+					section.benchmarks.push_back(run_benchmark<Config, Body, tries, Params...>());
+				}
+			}
+
+			template <typename... Tests>
+			void operator()(const detail::section<Tests...> nested) {
+				bench_section result{nested.name, {}, {}};
+				bench_items<unknown_section_patterns()> items{result};
+				foreach
+					<void>(nested.tests, [&](auto item) { items(item); });
+				section.sections.push_back(std::move(result));
+			}
+
+			// tests are left to the test runner
+			template <typename Item>
+			void operator()(const Item) {
+			}
+		};
+
+		inline std::ostream &print_benchmarks(std::ostream &stream, const std::string &root,
+		                                      const bench_section &section) {
+			std::string suite = root + section.name + ".";
+			stream << "[----------] " << section.num_benchmarks() << " benchmarks from "
+			       << section.name << std::endl;
+			for (const bench_result &bench : section.benchmarks) {
+				print_benchmark(stream, suite, bench);
+			}
+			for (const bench_section &nested : section.sections) {
+				print_benchmarks(stream, suite, nested);
+			}
+			stream << "[----------] " << section.num_benchmarks() << " benchmarks from "
+			       << section.name << " (0 ms total)" << std::endl;
+			return stream;
+		}
+
+		struct bench_printer {
+			std::vector<bench_section> sections;
+		};
+
+		inline std::ostream &operator<<(std::ostream &stream, const bench_printer &printer) {
+			unsigned num_benchmarks = 0;
+			for (const bench_section &section : printer.sections) {
+				num_benchmarks += section.num_benchmarks();
+			}
+			std::size_t num_suites = printer.sections.size();
+
+			stream << "[==========] Running " << num_benchmarks
+			       << (num_benchmarks == 1 ? " benchmark" : " benchmarks") << " from "
+			       << num_suites << " test " << (num_suites == 1 ? "case." : "cases.")
+			       << std::endl
+			       << "Seed: " << random_seed::key << std::endl;
+			for (const bench_section &section : printer.sections) {
+				print_benchmarks(stream, "", section);
+			}
+			stream << std::endl
+			       << "[----------] Global test environment tear-down" << std::endl
+			       << "[==========] " << num_benchmarks
+			       << (num_benchmarks == 1 ? " benchmark" : " benchmarks") << " from "
+			       << num_suites << " test " << (num_suites == 1 ? "case" : "cases")
+			       << " ran. (0 ms total)" << std::endl;
+			return stream;
+		}
+	} // namespace detail
+
+	/// a benchmark that times Body with the types generated by Params
+	/// \tparam Body the work to time, the call operator of Body<Ts...> is called for every case
+	/// \tparam tries the number of cases to generate
+	/// \tparam Params the parameter generators, the same as those of a test
+	template <template <typename...> class Body, unsigned tries, typename... Params>
+	constexpr detail::benchmark<config<>, Body, tries, Params...> benchmark{};
+
+	/// a benchmark like benchmark, with the options set by a config, see config.hpp
+	template <typename Config, template <typename...> class Body, unsigned tries,
+	          typename... Params>
+	constexpr detail::benchmark<Config, Body, tries, Params...> benchmark_with{};
+
+	/// time the benchmarks of the sections; the result prints like the result of test_all
+	template <typename... Sections>
+	detail::bench_printer run_benchmarks(const Sections... sections) {
+		detail::bench_printer printer;
+		foreach
+			<void>(std::make_tuple(sections...), [&](auto section) {
+				detail::bench_section result{section.name, {}, {}};
+				detail::bench_items<detail::unknown_section_patterns()> items{result};
+				foreach
+					<void>(section.tests, [&](auto item) { items(item); });
+				printer.sections.push_back(std::move(result));
+			});
+		return printer;
+	}
+} // namespace mc
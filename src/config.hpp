@@ -0,0 +1,119 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// per test configuration; a config is built from the defaults with a list of options applied on
+// top of them, every option overrides a single setting
+#pragma once
+
+#include <limits>
+
+namespace mc {
+	namespace detail {
+		struct default_config {
+			/// the maximum number of successful shrink steps, unbounded so a counterexample is
+			/// shrunk until none of its shrinks fail
+			constexpr static unsigned max_shrinks = std::numeric_limits<unsigned>::max();
+			/// the maximum number of shrink candidates that the function is called with
+			constexpr static unsigned max_candidates = std::numeric_limits<unsigned>::max();
+			/// the size of the last try, the tries before it grow linearly towards it
+			constexpr static unsigned max_size = 100;
+			/// the maximum number of values and lists generated for a single try
+			constexpr static unsigned max_nodes = 4096;
+			/// the maximum number of lists nested in each other in a single try
+			constexpr static unsigned max_depth = 8;
+			/// the untimed runs of a benchmark before it is timed, see benchmark.hpp
+			constexpr static unsigned warmup = 3;
+			/// the timed runs of a benchmark, of which the median is reported
+			constexpr static unsigned repetitions = 15;
+			/// the number of slowest generated cases that a benchmark reports
+			constexpr static unsigned slowest = 5;
+		};
+
+		template <typename Config, typename... Options>
+		struct apply_options {
+			using type = Config;
+		};
+		template <typename Config, typename Option, typename... Options>
+		struct apply_options<Config, Option, Options...>
+		        : apply_options<typename Option::template apply<Config>, Options...> {};
+	} // namespace detail
+
+	/// stop shrinking after n successful shrink steps
+	template <unsigned n>
+	struct max_shrinks {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned max_shrinks = n;
+		};
+	};
+
+	/// stop shrinking after the function was called with n shrink candidates
+	template <unsigned n>
+	struct max_candidates {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned max_candidates = n;
+		};
+	};
+
+	/// generate the values of the last try with size n, nominal_size is the full range of every
+	/// generator
+	template <unsigned n>
+	struct max_size {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned max_size = n;
+		};
+	};
+
+	/// generate at most n values and lists for a single try; longer lists are cut short
+	template <unsigned n>
+	struct max_nodes {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned max_nodes = n;
+		};
+	};
+
+	/// nest lists at most n deep in a single try; deeper lists are generated empty
+	template <unsigned n>
+	struct max_depth {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned max_depth = n;
+		};
+	};
+
+	/// run a benchmark n times before timing it, to warm up the caches and the branch predictors
+	template <unsigned n>
+	struct warmup {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned warmup = n;
+		};
+	};
+
+	/// time a benchmark n times, and report the median
+	template <unsigned n>
+	struct repetitions {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned repetitions = n;
+		};
+	};
+
+	/// report the n generated cases of a benchmark that took the longest
+	template <unsigned n>
+	struct slowest {
+		template <typename Config>
+		struct apply : Config {
+			constexpr static unsigned slowest = n;
+		};
+	};
+
+	/// the configuration of a test, the defaults with the options applied in order
+	template <typename... Options>
+	using config = typename detail::apply_options<detail::default_config, Options...>::type;
+} // namespace mc
@@ -0,0 +1,426 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the compile time core of metacheck: the definition of tests and sections, generating the tries
+// of a test and shrinking a counterexample; nothing in here depends on the reporting, so it can be
+// used without <iostream> or RTTI
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <kvasir/mpl/mpl.hpp>
+
+#include "config.hpp"
+#include "generators.hpp"
+#include "random.hpp"
+#include "utility.hpp"
+
+namespace mc {
+	namespace kmpl = kvasir::mpl;
+
+	namespace detail {
+		template <template <typename...> class Func, typename seed, typename Result,
+		          unsigned budget_hits = 0>
+		struct call_generated_result {
+			/// the result of the function being called with the generated parameters
+			using result = mc::mpl::call<Func, typename Result::type>;
+			/// the next seed that should be used when it is wanted to generate more numbers
+			using next_seed = seed;
+			/// the parameters that were used in the function call; can be any list type
+			using parameters = Result;
+			/// the number of times the budget cut the parameters short
+			constexpr static unsigned hits = budget_hits;
+		};
+
+		template <template <typename...> class Func, typename Result>
+		using call_generated_impl = call_generated_result<Func, typename Result::next_seed,
+		                                                  typename Result::type, Result::hits>;
+
+		template <template <typename...> class Func, typename seed, typename... Params>
+		using call_generated =
+		        call_generated_impl<Func, gen::detail::generate_all<seed, gen::value::list, 0,
+		                                                            Params...>>;
+
+		template <typename Params, unsigned shrinks, unsigned candidates, bool partial = false>
+		struct minify_result {
+			using parameters                           = Params;
+			constexpr static unsigned total_shrinks    = shrinks;
+			constexpr static unsigned total_candidates = candidates;
+			/// true when shrinking stopped at one of the limits of the test
+			constexpr static bool partially_shrunk = partial;
+		};
+
+		/// the number of candidates that may still be called, none once a limit was reached
+		template <typename Config, unsigned shrinks, unsigned candidates>
+		struct shrink_budget {
+			constexpr static unsigned value =
+			        shrinks < Config::max_shrinks && candidates < Config::max_candidates
+			                ? Config::max_candidates - candidates
+			                : 0;
+		};
+
+		/// index of the first false value, or the amount of values if they are all true
+		constexpr unsigned first_failure(std::initializer_list<bool> passed) {
+			unsigned index = 0;
+			for (bool pass : passed) {
+				if (!pass) {
+					return index;
+				}
+				++index;
+			}
+			return index;
+		}
+
+		/// the candidates without duplicates and without the value they were shrunk from, so
+		/// the function is never called twice with the same parameters
+		template <typename Current, typename Candidates>
+		struct unique_candidates;
+		template <typename Current, typename... Candidates>
+		struct unique_candidates<Current, kmpl::list<Candidates...>> {
+			template <typename T, std::size_t index>
+			using keep = kmpl::bool_<(!std::is_same<T, Current>::value &&
+			                          first_failure({!std::is_same<T, Candidates>::value...}) ==
+			                                  index)>;
+
+			template <typename Indices>
+			struct impl;
+			template <std::size_t... Indices>
+			struct impl<std::index_sequence<Indices...>> {
+				using type = kmpl::call<
+				        kmpl::join<>, typename std::conditional<keep<Candidates, Indices>::value,
+				                                                kmpl::list<Candidates>,
+				                                                kmpl::list<>>::type...>;
+			};
+
+			using type = typename impl<std::index_sequence_for<Candidates...>>::type;
+		};
+
+		template <unsigned evaluated, typename Found, bool exhausted_budget>
+		struct search_result {
+			/// the number of candidates that were called
+			constexpr static unsigned count = evaluated;
+			constexpr static bool found     = !std::is_same<Found, void>::value;
+			/// true when candidates were left untried because the budget ran out
+			constexpr static bool exhausted = exhausted_budget;
+			using type                      = Found;
+		};
+
+		template <bool done>
+		struct search_impl;
+		template <>
+		struct search_impl<true> {
+			template <template <typename> class Fails, unsigned budget, unsigned evaluated,
+			          typename Found, typename... Candidates>
+			struct f {
+				using type = search_result<evaluated, Found,
+				                           (std::is_same<Found, void>::value &&
+				                            sizeof...(Candidates) > 0)>;
+			};
+		};
+		template <>
+		struct search_impl<false> {
+			template <template <typename> class Fails, unsigned budget, unsigned evaluated,
+			          typename Found, typename Candidate, typename... Candidates>
+			struct f {
+				constexpr static bool fails = Fails<Candidate>::value;
+
+				using type = typename search_impl<(fails || sizeof...(Candidates) == 0 ||
+				                                   evaluated + 1 == budget)>::
+				        template f<Fails, budget, evaluated + 1,
+				                   typename std::conditional<fails, Candidate, void>::type,
+				                   Candidates...>::type;
+			};
+		};
+
+		/// call at most budget candidates in order until one of them fails, without
+		/// instantiating the function for any candidate after it
+		template <template <typename> class Fails, unsigned budget, typename... Candidates>
+		using search = typename search_impl<(sizeof...(Candidates) == 0 || budget == 0)>::
+		        template f<Fails, budget, 0, void, Candidates...>::type;
+
+		template <template <typename> class Fails, unsigned budget, typename Candidates>
+		struct search_list;
+		template <template <typename> class Fails, unsigned budget, typename... Candidates>
+		struct search_list<Fails, budget, kmpl::list<Candidates...>> {
+			using type = search<Fails, budget, Candidates...>;
+		};
+
+		template <bool found>
+		struct minify_select;
+
+		/// greedily replace the parameters by the first of their shrinks that still fails, until
+		/// none of the shrinks fail anymore or a limit of the test is reached
+		template <typename Config, template <typename...> class Func, unsigned shrinks = 0,
+		          unsigned candidates = 0>
+		struct minify {
+			// find a test that also fails the function
+			template <typename Params>
+			struct fails {
+				constexpr static bool value = !mpl::call<Func, typename Params::type>::value;
+			};
+
+			template <typename Params,
+			          typename Search = typename search_list<
+			                  fails, shrink_budget<Config, shrinks, candidates>::value,
+			                  typename unique_candidates<
+			                          Params, typename gen::shrink<Params>::type>::type>::type>
+			using f = typename minify_select<Search::found>::template f<Config, Func, shrinks,
+			                                                            candidates, Params, Search>;
+		};
+
+		template <>
+		struct minify_select<false> {
+			template <typename Config, template <typename...> class Func, unsigned shrinks,
+			          unsigned candidates, typename Params, typename Search>
+			using f = minify_result<Params, shrinks, candidates + Search::count,
+			                        Search::exhausted>;
+		};
+		template <>
+		struct minify_select<true> {
+			template <typename Config, template <typename...> class Func, unsigned shrinks,
+			          unsigned candidates, typename Params, typename Search>
+			using f = typename minify<Config, Func, shrinks + 1, candidates + Search::count>::
+			        template f<typename Search::type>;
+		};
+
+		template <unsigned n, unsigned shrinks, unsigned candidates, typename List>
+		struct ddmin_state {
+			using list                                 = List;
+			constexpr static unsigned granularity      = n;
+			constexpr static unsigned total_shrinks    = shrinks;
+			constexpr static unsigned total_candidates = candidates;
+		};
+
+		template <typename List>
+		struct list_size;
+		template <template <typename...> class Seq, typename... Ts>
+		struct list_size<Seq<Ts...>> {
+			constexpr static unsigned value = sizeof...(Ts);
+		};
+
+		template <unsigned index, typename Params>
+		struct param_at;
+		template <unsigned index, typename... Params>
+		struct param_at<index, gen::value::list<Params...>> {
+			using type = kmpl::call<kmpl::at<kmpl::uint_<index>>, Params...>;
+		};
+
+		/// delta debugging (ddmin) of the list_of parameter at index: remove chunks of decreasing
+		/// size from the list until not a single element can be removed anymore
+		template <typename Config, template <typename...> class Func, typename Params,
+		          unsigned index>
+		struct ddmin;
+		template <typename Config, template <typename...> class Func, typename... Params,
+		          unsigned index>
+		struct ddmin<Config, Func, gen::value::list<Params...>, index> {
+			/// the parameters with the list at index replaced
+			template <typename List>
+			using with = kmpl::call<
+			        kmpl::fork<kmpl::take<kmpl::uint_<index>>, kmpl::always<kmpl::list<List>>,
+			                   kmpl::drop<kmpl::uint_<index + 1>>,
+			                   kmpl::join<kmpl::cfe<gen::value::list>>>,
+			        Params...>;
+
+			template <typename List>
+			struct fails {
+				constexpr static bool value = !mpl::call<Func, typename with<List>::type>::value;
+			};
+
+			/// the elements from begin to end, and everything but those elements
+			template <unsigned begin, unsigned end, typename... Ts>
+			using chunk = kmpl::call<
+			        kmpl::drop<kmpl::uint_<begin>,
+			                   kmpl::take<kmpl::uint_<end - begin>,
+			                              kmpl::cfe<gen::value::list_of>>>,
+			        Ts...>;
+			template <unsigned begin, unsigned end, typename... Ts>
+			using without = kmpl::call<kmpl::fork<kmpl::take<kmpl::uint_<begin>>,
+			                                      kmpl::drop<kmpl::uint_<end>>,
+			                                      kmpl::join<kmpl::cfe<gen::value::list_of>>>,
+			                           Ts...>;
+
+			template <typename State, typename List = typename State::list,
+			          typename Chunks = std::make_index_sequence<State::granularity>>
+			struct step;
+			template <typename State, typename... Ts, std::size_t... Chunks>
+			struct step<State, gen::value::list_of<Ts...>, std::index_sequence<Chunks...>> {
+				constexpr static unsigned n    = State::granularity;
+				constexpr static unsigned size = sizeof...(Ts);
+
+				// first try to reduce the list to a single chunk, then to remove a single chunk;
+				// with two chunks both are the same
+				using chunks = typename unique_candidates<
+				        gen::value::list_of<Ts...>,
+				        kmpl::list<chunk<Chunks * size / n, (Chunks + 1) * size / n,
+				                         Ts...>...>>::type;
+				using candidates = typename unique_candidates<
+				        gen::value::list_of<Ts...>,
+				        typename std::conditional<
+				                (n > 2),
+				                kmpl::call<kmpl::join<>, chunks,
+				                           kmpl::list<without<Chunks * size / n,
+				                                              (Chunks + 1) * size / n, Ts...>...>>,
+				                chunks>::type>::type;
+
+				using result = typename search_list<
+				        fails,
+				        shrink_budget<Config, State::total_shrinks,
+				                      State::total_candidates>::value,
+				        candidates>::type;
+
+				using list = typename std::conditional<result::found, typename result::type,
+				                                       gen::value::list_of<Ts...>>::type;
+
+				// restart from two chunks after reducing to a chunk, keep the granularity after
+				// removing a chunk, and split the chunks when none of them could be removed; the
+				// chunks come first among the candidates, counted after dropping duplicates
+				constexpr static unsigned next_n =
+				        result::found ? (result::count <= list_size<chunks>::value || n <= 3
+				                                 ? 2
+				                                 : n - 1)
+				                      : (n * 2 < size ? n * 2 : size);
+
+				// done when the list is too short to split, when single elements were tried, or
+				// when a limit of the test was reached
+				constexpr static bool done =
+				        result::exhausted ||
+				        (result::found ? list_size<list>::value < 2 : n >= size);
+
+				using next = ddmin_state<next_n, State::total_shrinks + result::found,
+				                         State::total_candidates + result::count, list>;
+			};
+
+			template <typename Step, bool done = Step::done>
+			struct run {
+				using type = minify_result<with<typename Step::next::list>,
+				                           Step::next::total_shrinks,
+				                           Step::next::total_candidates, Step::result::exhausted>;
+			};
+			template <typename Step>
+			struct run<Step, false> {
+				using type = typename run<step<typename Step::next>>::type;
+			};
+
+			/// the minify_result after removing as much from the list as possible
+			template <unsigned shrinks, unsigned candidates, typename List>
+			using f = typename run<step<ddmin_state<2, shrinks, candidates, List>>>::type;
+		};
+
+		template <bool reducible>
+		struct ddmin_param;
+		template <>
+		struct ddmin_param<false> {
+			template <typename Config, template <typename...> class Func, typename Result,
+			          unsigned index>
+			using f = Result;
+		};
+		template <>
+		struct ddmin_param<true> {
+			template <typename Config, template <typename...> class Func, typename Result,
+			          unsigned index>
+			using f = typename ddmin<Config, Func, typename Result::parameters, index>::template f<
+			        Result::total_shrinks, Result::total_candidates,
+			        typename param_at<index, typename Result::parameters>::type>;
+		};
+
+		template <typename T>
+		struct is_reducible_list : std::false_type {};
+		template <typename T, typename U, typename... Ts>
+		struct is_reducible_list<gen::value::list_of<T, U, Ts...>> : std::true_type {};
+
+		/// run ddmin on every list_of parameter, in order
+		template <typename Config, template <typename...> class Func, unsigned index,
+		          unsigned count>
+		struct ddmin_all {
+			template <typename Result>
+			using f = typename ddmin_all<Config, Func, index + 1, count>::template f<
+			        typename ddmin_param<is_reducible_list<typename param_at<
+			                index, typename Result::parameters>::type>::value>::
+			                template f<Config, Func, Result, index>>;
+		};
+		template <typename Config, template <typename...> class Func, unsigned count>
+		struct ddmin_all<Config, Func, count, count> {
+			template <typename Result>
+			using f = Result;
+		};
+
+		/// shrink a counterexample: first remove as many elements as possible from the list
+		/// parameters with ddmin, then greedily shrink whatever is left
+		template <typename Config, template <typename...> class Func, typename Params>
+		struct shrink_all {
+			using lists = typename ddmin_all<Config, Func, 0, list_size<Params>::value>::
+			        template f<minify_result<Params, 0, 0>>;
+
+			using values = typename minify<Config, Func, lists::total_shrinks,
+			                               lists::total_candidates>::
+			        template f<typename lists::parameters>;
+
+			using type = minify_result<typename values::parameters, values::total_shrinks,
+			                           values::total_candidates,
+			                           lists::partially_shrunk || values::partially_shrunk>;
+		};
+
+		/// the size of a try; the tries grow linearly from size 0 up to the maximum size of the
+		/// test, so the first tries are cheap to generate and only the last ones are full size
+		constexpr unsigned try_size(unsigned try_num, unsigned tries, unsigned max_size) {
+			return tries > 1 ? uint64_t(try_num) * max_size / (tries - 1) : max_size;
+		}
+
+		/// the seed of a single try; split directly from the seed of the test, so no try depends
+		/// on the ones before it, and with the budget of the test
+		template <typename Config, typename seed, unsigned try_num, unsigned tries>
+		using try_seed = typename seed::template split<
+		        try_num, budget<Config::max_nodes, Config::max_depth>>::
+		        template with_size<try_size(try_num, tries, Config::max_size)>;
+
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename... Params>
+		struct test {};
+
+		/// single section consisting of multiple tests
+		template <typename... Tests>
+		struct section {
+			const char *name; // pod type constructor
+			std::tuple<Tests...> tests;
+		};
+
+		/// the seed of a test; it only depends on the random seed and on the definition of the
+		/// test, so a test keeps its seed, and its instantiations, when other tests are added,
+		/// removed or moved
+		template <typename Test>
+		using test_seed = seed_state<type_hash<Test>(random_seed::key)>;
+
+		/// the identity of a test, which tells apart the tests of the same function in a
+		/// section; unlike the seed of the test it does not change with the random seed
+		template <typename Test>
+		constexpr uint64_t test_id() {
+			return type_hash<Test>(golden_gamma);
+		}
+	} // namespace detail
+
+	/// a single test case testing a function
+	/// \tparam Func the function that is to be tested, should be convertible to bool, true if
+	///             the test passed, and false if the test failed
+	/// \tparam tries the number of times the function should be tried with different parameters
+	/// \tparam Params the parameter generators that create the parameters to be passed into the
+	///             function
+	template <template <typename...> class Func, unsigned tries, typename... Params>
+	constexpr detail::test<config<>, Func, tries, Params...> test{};
+
+	/// a single test case like test, with the options of the test set by a config
+	/// \tparam Config the configuration of the test, see config.hpp
+	template <typename Config, template <typename...> class Func, unsigned tries,
+	          typename... Params>
+	constexpr detail::test<Config, Func, tries, Params...> test_with{};
+
+	template <typename... Tests>
+	constexpr detail::section<Tests...> section(const char *name, const Tests... tests) {
+		return {.name = name, .tests = std::make_tuple(tests...)};
+	}
+} // namespace mc
@@ -0,0 +1,552 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// tests of constexpr functions over values, beside the tests of metafunctions over types:
+//
+//   struct sorted_after_sort {
+//       constexpr bool operator()(mc::carray<int, 16> values) const { ... }
+//   };
+//   mc::ctest<sorted_after_sort, 1000, mc::cgen::array_of<mc::cgen::int_<>, 16>>
+//
+// the tries are generated, called and shrunk in a constexpr loop instead of by instantiating
+// templates, so a test costs a few instantiations however many tries it has. the property is a
+// literal class type with a constexpr call operator; it has to be a constant expression for every
+// value it is called with, so undefined behaviour like a signed overflow is a compile error
+// instead of a failure
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <utility>
+
+#include "config.hpp"
+#include "core.hpp"
+#include "filter.hpp"
+#include "random.hpp"
+#include "report.hpp"
+#include "type_name.hpp"
+
+namespace mc {
+	/// an array of up to capacity values, the value that cgen::array_of generates
+	template <typename T, unsigned capacity>
+	struct carray {
+		T data[capacity == 0 ? 1 : capacity];
+		unsigned length;
+
+		constexpr unsigned size() const {
+			return length;
+		}
+		constexpr const T &operator[](unsigned index) const {
+			return data[index];
+		}
+		constexpr T &operator[](unsigned index) {
+			return data[index];
+		}
+		constexpr const T *begin() const {
+			return data;
+		}
+		constexpr const T *end() const {
+			return data + length;
+		}
+		constexpr T *begin() {
+			return data;
+		}
+		constexpr T *end() {
+			return data + length;
+		}
+	};
+
+	namespace detail {
+		/// the stream of random numbers of a single try, the same stream as that of a seed_state
+		/// with the same key
+		struct crandom {
+			uint64_t key;
+			uint64_t counter;
+
+			constexpr uint64_t next() {
+				return mix64(key + ++counter * golden_gamma);
+			}
+
+			/// a number from 0 up to and including max
+			constexpr uint64_t up_to(uint64_t max) {
+				return max == std::numeric_limits<uint64_t>::max() ? next() : next() % (max + 1);
+			}
+		};
+
+		/// the key of the n-th child of the seed with the given key, like seed_state::split
+		constexpr uint64_t split_key(uint64_t key, uint64_t n) {
+			return mix64(mix64(key + golden_gamma) + (n + 1) * golden_gamma);
+		}
+
+		/// writes the text of a value, or only counts its length when there is no buffer
+		struct ctext_writer {
+			char *data;
+			unsigned length;
+
+			constexpr void put(char c) {
+				if (data != nullptr) {
+					data[length] = c;
+				}
+				++length;
+			}
+
+			constexpr void put(const char *str) {
+				while (*str != '\0') {
+					put(*str++);
+				}
+			}
+
+			constexpr void put_uint(uint64_t value) {
+				uint64_t digit = 1;
+				while (value / digit >= 10) {
+					digit *= 10;
+				}
+				for (; digit != 0; digit /= 10) {
+					put(char('0' + value / digit % 10));
+				}
+			}
+
+			constexpr void put_int(int64_t value) {
+				if (value < 0) {
+					put('-');
+					// negate as unsigned, so the lowest value does not overflow
+					put_uint(uint64_t(0) - uint64_t(value));
+				} else {
+					put_uint(uint64_t(value));
+				}
+			}
+		};
+
+		/// the text of count values, value i ends at ends[i]
+		template <unsigned capacity, unsigned count>
+		struct ctext {
+			char data[capacity];
+			unsigned ends[count + 1];
+
+			constexpr unsigned begin(unsigned index) const {
+				return index == 0 ? 0 : ends[index - 1];
+			}
+		};
+
+		/// the statistics of a generated value, see gen::stats
+		struct cstats {
+			unsigned nodes, depth, lists, total_length, min_length, max_length;
+		};
+
+		constexpr cstats scalar_stats() {
+			return {1, 0, 0, 0, std::numeric_limits<unsigned>::max(), 0};
+		}
+
+		/// the statistics of several values together
+		constexpr cstats combine_stats(const cstats &a, const cstats &b) {
+			return {a.nodes + b.nodes,
+			        max_of({a.depth, b.depth}),
+			        a.lists + b.lists,
+			        a.total_length + b.total_length,
+			        min_of({a.min_length, b.min_length}),
+			        max_of({a.max_length, b.max_length})};
+		}
+
+		/// the try_record of a single try
+		constexpr try_record try_record_of(const cstats &s) {
+			return {1,       0,       s.nodes,        s.nodes,        s.nodes,
+			        s.depth, s.depth, s.depth,        s.lists,        s.min_length,
+			        s.total_length,   s.max_length};
+		}
+
+		/// the integral values from min up to and including max, shrunk towards the value in the
+		/// range that is closest to 0
+		template <typename T, int64_t max, int64_t min>
+		struct cintegral {
+			static_assert(min <= max, "the minimum of a generator is above its maximum");
+
+			using type = T;
+
+			constexpr static int64_t target = min > 0 ? min : max < 0 ? max : 0;
+
+			constexpr static type generate(crandom &random, unsigned size) {
+				// the range around the target grows with the size
+				uint64_t below = scale_to_size(uint64_t(target - min), size);
+				uint64_t above = scale_to_size(uint64_t(max - target), size);
+				return type(target - int64_t(below) + int64_t(random.up_to(below + above)));
+			}
+
+			/// the distance of value from the target
+			constexpr static uint64_t distance(type value) {
+				return int64_t(value) < target ? uint64_t(target - int64_t(value))
+				                               : uint64_t(int64_t(value) - target);
+			}
+
+			constexpr static unsigned shrink_count(type value) {
+				return distance(value) < 3 ? unsigned(distance(value)) : 3;
+			}
+
+			/// the target, halfway to the target, and one step towards the target
+			constexpr static type shrink_at(type value, unsigned index) {
+				int64_t step = int64_t(value) < target ? 1 : -1;
+				return index == 0 ? type(target)
+				                  : index == 1 ? type(target - step * int64_t(distance(value) / 2))
+				                               : type(int64_t(value) + step);
+			}
+
+			constexpr static void print(type value, ctext_writer &out) {
+				out.put_int(int64_t(value));
+			}
+
+			constexpr static cstats stats(type) {
+				return scalar_stats();
+			}
+		};
+	} // namespace detail
+
+	/// the constexpr generators of ctest, every one generates values of its type, and knows how
+	/// to shrink and print them
+	namespace cgen {
+		/// an int from min up to and including max
+		template <int max = 1024, int min = -1024>
+		struct int_ : detail::cintegral<int, max, min> {};
+
+		/// an unsigned from min up to and including max
+		template <unsigned max = 2048, unsigned min = 0>
+		struct uint_ : detail::cintegral<unsigned, max, min> {};
+
+		/// true or false, shrinks to false
+		struct bool_ {
+			using type = bool;
+
+			constexpr static type generate(detail::crandom &random, unsigned) {
+				return random.next() & 1;
+			}
+
+			constexpr static unsigned shrink_count(type value) {
+				return value ? 1 : 0;
+			}
+
+			constexpr static type shrink_at(type, unsigned) {
+				return false;
+			}
+
+			constexpr static void print(type value, detail::ctext_writer &out) {
+				out.put(value ? "true" : "false");
+			}
+
+			constexpr static detail::cstats stats(type) {
+				return detail::scalar_stats();
+			}
+		};
+
+		/// an array of up to capacity values of Gen, of which the length grows with the size;
+		/// shrinks by leaving out elements and by shrinking elements
+		template <typename Gen, unsigned capacity = 16>
+		struct array_of {
+			using type = carray<typename Gen::type, capacity>;
+
+			constexpr static type generate(detail::crandom &random, unsigned size) {
+				type value{};
+				value.length = unsigned(random.up_to(scale_to_size(capacity, size)));
+				for (unsigned i = 0; i < value.length; ++i) {
+					value[i] = Gen::generate(random, size);
+				}
+				return value;
+			}
+
+			constexpr static unsigned shrink_count(const type &value) {
+				unsigned count = value.length;
+				for (unsigned i = 0; i < value.length; ++i) {
+					count += Gen::shrink_count(value[i]);
+				}
+				return count;
+			}
+
+			/// the array without one element, or with one element shrunk
+			constexpr static type shrink_at(const type &value, unsigned index) {
+				type shrunk = value;
+				if (index < value.length) {
+					for (unsigned i = index; i + 1 < value.length; ++i) {
+						shrunk[i] = value[i + 1];
+					}
+					--shrunk.length;
+					return shrunk;
+				}
+				index -= value.length;
+				unsigned i = 0;
+				while (index >= Gen::shrink_count(value[i])) {
+					index -= Gen::shrink_count(value[i++]);
+				}
+				shrunk[i] = Gen::shrink_at(value[i], index);
+				return shrunk;
+			}
+
+			constexpr static void print(const type &value, detail::ctext_writer &out) {
+				out.put('{');
+				for (unsigned i = 0; i < value.length; ++i) {
+					if (i != 0) {
+						out.put(", ");
+					}
+					Gen::print(value[i], out);
+				}
+				out.put('}');
+			}
+
+			constexpr static detail::cstats stats(const type &value) {
+				detail::cstats elements{0, 0, 0, 0, std::numeric_limits<unsigned>::max(), 0};
+				for (unsigned i = 0; i < value.length; ++i) {
+					elements = detail::combine_stats(elements, Gen::stats(value[i]));
+				}
+				return {elements.nodes + 1,
+				        elements.depth + 1,
+				        elements.lists + 1,
+				        elements.total_length + value.length,
+				        detail::min_of({elements.min_length, value.length}),
+				        detail::max_of({elements.max_length, value.length})};
+			}
+		};
+	} // namespace cgen
+
+	namespace detail {
+		/// the parameters of a single try, one value of every generator
+		template <typename... Gens>
+		struct cparams {
+			constexpr static cparams generate(crandom &, unsigned) {
+				return {};
+			}
+
+			constexpr unsigned shrink_count() const {
+				return 0;
+			}
+
+			constexpr cparams shrink_at(unsigned) const {
+				return *this;
+			}
+
+			/// call Prop with the values before these, and these
+			template <typename Prop, typename... Args>
+			constexpr bool call(const Args &... args) const {
+				return bool(Prop{}(args...));
+			}
+
+			constexpr void print(ctext_writer &, unsigned *) const {
+			}
+
+			constexpr cstats stats() const {
+				return {0, 0, 0, 0, std::numeric_limits<unsigned>::max(), 0};
+			}
+		};
+		template <typename Gen, typename... Gens>
+		struct cparams<Gen, Gens...> {
+			typename Gen::type head;
+			cparams<Gens...> tail;
+
+			constexpr static cparams generate(crandom &random, unsigned size) {
+				// the elements of a braced list are evaluated in order
+				return {Gen::generate(random, size), cparams<Gens...>::generate(random, size)};
+			}
+
+			constexpr unsigned shrink_count() const {
+				return Gen::shrink_count(head) + tail.shrink_count();
+			}
+
+			/// the parameters with one of them shrunk
+			constexpr cparams shrink_at(unsigned index) const {
+				cparams shrunk = *this;
+				if (index < Gen::shrink_count(head)) {
+					shrunk.head = Gen::shrink_at(head, index);
+				} else {
+					shrunk.tail = tail.shrink_at(index - Gen::shrink_count(head));
+				}
+				return shrunk;
+			}
+
+			template <typename Prop, typename... Args>
+			constexpr bool call(const Args &... args) const {
+				return tail.template call<Prop>(args..., head);
+			}
+
+			/// print every value, and where it ends
+			constexpr void print(ctext_writer &out, unsigned *ends) const {
+				Gen::print(head, out);
+				*ends = out.length;
+				tail.print(out, ends + 1);
+			}
+
+			constexpr cstats stats() const {
+				return combine_stats(Gen::stats(head), tail.stats());
+			}
+		};
+
+		/// the parameters of a try of a test
+		template <typename Config, typename Params>
+		constexpr Params generate_try(uint64_t key, unsigned try_num, unsigned tries) {
+			crandom random{split_key(key, try_num), 0};
+			return Params::generate(random, try_size(try_num, tries, Config::max_size));
+		}
+
+		/// the result of the tries of a constexpr test
+		template <typename Params>
+		struct cresult {
+			bool failed;
+			/// the failing try, counted from 1; 0 when the test passed
+			unsigned failnum;
+			/// the key of the seed of the failing try
+			uint64_t key;
+			unsigned shrinks, candidates;
+			/// true when shrinking stopped at one of the limits of the test
+			bool partial;
+			try_record summary;
+			/// the counterexample
+			Params params;
+		};
+
+		/// call Prop with the tries from first up to last of a test with the given key, up to the
+		/// first one that fails
+		template <typename Config, typename Prop, typename Params>
+		constexpr cresult<Params> ccheck_tries(uint64_t key, unsigned first, unsigned last,
+		                                       unsigned tries) {
+			cresult<Params> result{false, 0, key, 0, 0, false, {}, {}};
+			for (unsigned try_num = first; try_num < last; ++try_num) {
+				Params params   = generate_try<Config, Params>(key, try_num, tries);
+				result.summary  = combine(result.summary, try_record_of(params.stats()));
+				if (!params.template call<Prop>()) {
+					result.failed  = true;
+					result.failnum = try_num + 1;
+					result.params  = params;
+					return result;
+				}
+			}
+			return result;
+		}
+
+		/// the number of tries of a constexpr test that are run in a single constant expression;
+		/// compilers limit the number of operations that a constant expression may take, so the
+		/// tries are run in blocks, each of which is an instantiation of its own
+		constexpr unsigned ctest_block = 256;
+
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first, unsigned last>
+		struct ctries_block {
+			constexpr static cresult<Params> value =
+			        ccheck_tries<Config, Prop, Params>(key, first, last, tries);
+		};
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first, unsigned last>
+		constexpr cresult<Params>
+		        ctries_block<Config, Prop, Params, key, tries, first, last>::value;
+
+		/// the result of the first block that failed, with the tries of the blocks up to it
+		template <typename Params>
+		constexpr cresult<Params> merge_blocks(uint64_t key,
+		                                       std::initializer_list<cresult<Params>> blocks) {
+			cresult<Params> merged{false, 0, key, 0, 0, false, {}, {}};
+			for (const cresult<Params> &block : blocks) {
+				try_record summary = combine(merged.summary, block.summary);
+				if (block.failed) {
+					merged = block;
+				}
+				merged.summary = summary;
+				if (merged.failed) {
+					break;
+				}
+			}
+			return merged;
+		}
+
+		/// call Prop with the tries from first up to last, in blocks
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first, unsigned last,
+		          typename Blocks =
+		                  std::make_index_sequence<(last - first + ctest_block - 1) / ctest_block>>
+		struct ctries;
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first, unsigned last, std::size_t... Blocks>
+		struct ctries<Config, Prop, Params, key, tries, first, last,
+		              std::index_sequence<Blocks...>> {
+			constexpr static cresult<Params> value = merge_blocks<Params>(
+			        key, {ctries_block<Config, Prop, Params, key, tries,
+			                           first + unsigned(Blocks) * ctest_block,
+			                           min_of({last, first + unsigned(Blocks + 1) * ctest_block})>::
+			                      value...});
+		};
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first, unsigned last, std::size_t... Blocks>
+		constexpr cresult<Params> ctries<Config, Prop, Params, key, tries, first, last,
+		                                 std::index_sequence<Blocks...>>::value;
+
+		/// shrink the counterexample of a failed result, taking the first candidate that still
+		/// fails until none of them do or a limit of the test is hit
+		template <typename Config, typename Prop, typename Params>
+		constexpr cresult<Params> cshrink(cresult<Params> result) {
+			for (unsigned index = 0; index < result.params.shrink_count();) {
+				if (result.shrinks >= Config::max_shrinks ||
+				    result.candidates >= Config::max_candidates) {
+					result.partial = true;
+					break;
+				}
+				Params candidate = result.params.shrink_at(index);
+				++result.candidates;
+				if (!candidate.template call<Prop>()) {
+					result.params = candidate;
+					++result.shrinks;
+					index = 0;
+				} else {
+					++index;
+				}
+			}
+			return result;
+		}
+
+		/// the text of the parameters, capacity has to hold all of it
+		template <unsigned capacity, unsigned count, typename Params>
+		constexpr ctext<capacity, count> print_params(const Params &params) {
+			ctext<capacity, count> text{};
+			ctext_writer out{text.data, 0};
+			params.print(out, text.ends);
+			return text;
+		}
+
+		template <typename Params>
+		constexpr unsigned params_length(const Params &params) {
+			unsigned ends[64] = {};
+			ctext_writer out{nullptr, 0};
+			params.print(out, ends);
+			return out.length;
+		}
+
+		/// the unqualified name of the property, as the name of its test
+		template <typename Prop>
+		constexpr string_part ctest_name() {
+			string_part name = type_name<Prop>();
+			unsigned begin   = name.end;
+			while (begin > name.begin && name.str[begin - 1] != ':') {
+				--begin;
+			}
+			return {name.str, begin, name.end};
+		}
+
+		template <typename Prop>
+		constexpr bool cselected(uint64_t patterns) {
+			return test_selected(patterns, ctest_name<Prop>());
+		}
+
+		template <typename Config, typename Prop, unsigned tries, typename... Gens>
+		struct ctest {
+			static_assert(sizeof...(Gens) < 64, "a ctest takes less than 64 parameters");
+			static_assert(tries > 0, "a ctest takes at least one try");
+		};
+	} // namespace detail
+
+	/// a single test case testing a constexpr function over values
+	/// \tparam Prop a literal class type of which the constexpr call operator takes the
+	///             generated values, and returns true if the test passed
+	/// \tparam tries the number of times the function should be tried with different parameters
+	/// \tparam Gens the constexpr generators of the parameters, see namespace cgen
+	template <typename Prop, unsigned tries, typename... Gens>
+	constexpr detail::ctest<config<>, Prop, tries, Gens...> ctest{};
+
+	/// a single test case like ctest, with the options of the test set by a config; max_nodes
+	/// and max_depth do not apply, since the capacity of an array bounds its values
+	template <typename Config, typename Prop, unsigned tries, typename... Gens>
+	constexpr detail::ctest<Config, Prop, tries, Gens...> ctest_with{};
+} // namespace mc
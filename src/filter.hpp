@@ -0,0 +1,200 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compile time test selection, the equivalent of --gtest_filter; METACHECK_FILTER holds a list of
+// "section.test" patterns, and the tests that are not selected are skipped before anything of
+// them is instantiated
+//
+// the patterns are separated by ':', and the patterns after a '-' exclude tests instead of
+// selecting them; '*' matches any string and '?' any character, and a pattern without a '.'
+// only matches the name of the test, in any section
+#pragma once
+
+#include <cstdint>
+
+#include "reproduce.hpp"
+
+#ifndef METACHECK_FILTER
+#ifdef METACHECK_REPRODUCE
+// only compile the test that is reproduced
+#define METACHECK_FILTER METACHECK_STRINGIFY(METACHECK_REPRODUCE)
+#else
+#define METACHECK_FILTER "*"
+#endif
+#endif
+
+namespace mc {
+	namespace detail {
+		constexpr const char *test_filter = METACHECK_FILTER;
+
+		/// the characters of str from begin up to end
+		struct string_part {
+			const char *str;
+			unsigned begin;
+			unsigned end;
+		};
+
+		/// match a name against a glob pattern with '*' and '?' wildcards
+		constexpr bool glob_match(string_part pattern, string_part name) {
+			unsigned p = pattern.begin, n = name.begin;
+			// where to continue when a match after the last star fails
+			bool star = false;
+			unsigned star_p = 0, star_n = 0;
+			while (n < name.end) {
+				if (p < pattern.end && pattern.str[p] == '*') {
+					star   = true;
+					star_p = ++p;
+					star_n = n;
+				} else if (p < pattern.end &&
+				           (pattern.str[p] == '?' || pattern.str[p] == name.str[n])) {
+					++p;
+					++n;
+				} else if (star) {
+					// let the star swallow one more character
+					p = star_p;
+					n = ++star_n;
+				} else {
+					return false;
+				}
+			}
+			while (p < pattern.end && pattern.str[p] == '*') {
+				++p;
+			}
+			return p == pattern.end;
+		}
+
+		/// a single pattern of the filter
+		struct filter_pattern {
+			string_part section; // empty str when the pattern has no section part
+			string_part test;
+			bool negative;
+		};
+
+		constexpr bool is_separator(char c) {
+			return c == ':' || c == '-' || c == '\0';
+		}
+
+		constexpr unsigned pattern_count(const char *filter) {
+			unsigned count = 0;
+			for (unsigned pos = 0; filter[pos] != '\0'; ++pos) {
+				if (!is_separator(filter[pos]) && is_separator(filter[pos + 1])) {
+					++count;
+				}
+			}
+			return count;
+		}
+
+		/// the index-th pattern of the filter, index has to be less than the pattern count
+		constexpr filter_pattern pattern_at(const char *filter, unsigned index) {
+			unsigned begin = 0, pos = 0;
+			bool negative = false;
+			for (;; ++pos) {
+				if (is_separator(filter[pos])) {
+					if (pos != begin && index-- == 0) {
+						break;
+					}
+					negative = negative || filter[pos] == '-';
+					begin    = pos + 1;
+				}
+			}
+			for (unsigned dot = begin; dot < pos; ++dot) {
+				if (filter[dot] == '.') {
+					return {{filter, begin, dot}, {filter, dot + 1, pos}, negative};
+				}
+			}
+			return {{nullptr, 0, 0}, {filter, begin, pos}, negative};
+		}
+
+		constexpr unsigned string_length(const char *str) {
+			unsigned length = 0;
+			while (str[length] != '\0') {
+				++length;
+			}
+			return length;
+		}
+
+		/// the patterns (as bits) that apply to the tests in the section with the given name
+		constexpr uint64_t section_patterns(const char *section) {
+			uint64_t patterns = 0;
+			for (unsigned i = 0; i < pattern_count(test_filter) && i < 64; ++i) {
+				filter_pattern pattern = pattern_at(test_filter, i);
+				if (pattern.section.str == nullptr ||
+				    glob_match(pattern.section, {section, 0, string_length(section)})) {
+					patterns |= uint64_t(1) << i;
+				}
+			}
+			return patterns;
+		}
+
+		/// the patterns that apply to a section of which the name is only known at run time;
+		/// select a test when any section could select it, and only exclude it for the patterns
+		/// that do not depend on the section
+		constexpr uint64_t unknown_section_patterns() {
+			uint64_t patterns = 0;
+			for (unsigned i = 0; i < pattern_count(test_filter) && i < 64; ++i) {
+				filter_pattern pattern = pattern_at(test_filter, i);
+				if (!pattern.negative || pattern.section.str == nullptr) {
+					patterns |= uint64_t(1) << i;
+				}
+			}
+			return patterns;
+		}
+
+		/// whether the filter selects a test with the given name, using only the patterns that
+		/// apply to its section
+		constexpr bool test_selected(uint64_t patterns, string_part name) {
+			bool any_positive = false, selected = false;
+			for (unsigned i = 0; i < pattern_count(test_filter) && i < 64; ++i) {
+				filter_pattern pattern = pattern_at(test_filter, i);
+				any_positive           = any_positive || !pattern.negative;
+				if ((patterns >> i) & 1 && glob_match(pattern.test, name)) {
+					if (pattern.negative) {
+						return false;
+					}
+					selected = true;
+				}
+			}
+			// only exclusions select everything that is not excluded
+			return selected || !any_positive;
+		}
+
+		template <template <typename...> class F>
+		constexpr const char *pretty_function() {
+#ifdef _MSC_VER
+			return __FUNCSIG__;
+#else
+			return __PRETTY_FUNCTION__;
+#endif
+		}
+
+		/// the unqualified name of F at compile time, the same name that func_name prints
+		template <template <typename...> class F>
+		constexpr string_part test_name() {
+			const char *str = pretty_function<F>();
+			unsigned end    = string_length(str);
+#ifdef _MSC_VER
+			// "const char *__cdecl mc::detail::pretty_function<ns::F>(void)"
+			while (str[end] != '>') {
+				--end;
+			}
+#else
+			// "constexpr const char* mc::detail::pretty_function() [with F = ns::F]"
+			while (str[end] != ']') {
+				--end;
+			}
+#endif
+			unsigned begin = end;
+			while (str[begin - 1] != ':' && str[begin - 1] != ' ' && str[begin - 1] != '<') {
+				--begin;
+			}
+			return {str, begin, end};
+		}
+
+		template <template <typename...> class F>
+		constexpr bool selected(uint64_t patterns) {
+			return test_selected(patterns, test_name<F>());
+		}
+	} // namespace detail
+} // namespace mc
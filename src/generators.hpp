@@ -11,6 +11,7 @@
 
 #include <limits>
 #include <type_traits>
+#include <utility>
 
 #include <kvasir/mpl/mpl.hpp>
 
@@ -54,11 +55,14 @@ namespace mc {
 		} // namespace value
 
 		namespace detail {
-			template <typename seed, typename T>
+			template <typename seed, typename T, unsigned budget_hits = 0>
 			struct gen_result {
 				using next_seed = seed;
 
 				using type = T;
+
+				/// the number of times the budget of the seed cut the generated value short
+				constexpr static unsigned hits = budget_hits;
 			};
 		} // namespace detail
 
@@ -70,6 +74,7 @@ namespace mc {
 		};
 
 		/// uint template object, creates a uint somewhere within the range min to max, inclusive
+		/// the range is scaled down with the size of the seed, at size 0 it is always min
 		template <unsigned max = 2048, unsigned min = 0>
 		struct uint_ {
 			constexpr static unsigned max_num = max > min ? max : min;
@@ -78,17 +83,17 @@ namespace mc {
 			// generate a new int from a seed
 			template <typename seed>
 			using generate = detail::gen_result<
-			        typename seed::next::next,
-			        value::uint_<(((unsigned(seed{}) >> (typename seed::next{} % 32))
-			                       // random distribution weighted towards small values
-			                       % (max_num - (min_num))) +
-			                      (min_num))>>;
+			        typename seed::template jump<2>,
+			        value::uint_<unsigned(((unsigned(seed::at(0)) >> (seed::at(1) % 32))
+			                               // random distribution weighted towards small values
+			                               % (scale_to_size(max_num - min_num, seed::size) + 1)) +
+			                              min_num)>>;
 		};
 
 		struct bool_ {
 			template <typename seed>
 			using generate =
-			        detail::gen_result<typename seed::next, value::bool_<((seed{} % 2) == 1)>>;
+			        detail::gen_result<typename seed::next, value::bool_<((seed::at(0) % 2) == 1)>>;
 		};
 
 		template <typename... Ts>
@@ -96,7 +101,7 @@ namespace mc {
 			template <typename seed>
 			struct generate {
 				using random_value =
-				        typename mpl::call<mpl::at<mpl::uint_<(seed{} % sizeof...(Ts))>>,
+				        typename mpl::call<mpl::at<mpl::uint_<(seed::at(0) % sizeof...(Ts))>>,
 				                           Ts...>::template generate<typename seed::next>;
 
 				// skip one seed as it is used for the alternatives
@@ -104,50 +109,95 @@ namespace mc {
 
 				// use a single seed for all the alternatives as they are all exclusive anyways
 				using type = value::any<typename random_value::type, next_seed>;
+
+				constexpr static unsigned hits = random_value::hits;
 			};
 		};
 
-		namespace detail {
-			template <typename Seed, typename Elem>
-			using gen_func = typename Elem::template generate<typename Seed::next_seed>;
-
-			template <typename T>
-			using get_type = typename T::type;
+		/// generate with the size of the seed scaled by num / den, to make recursive generators
+		/// smaller at every level
+		template <typename Gen, unsigned num, unsigned den>
+		struct scale {
+			template <typename seed>
+			using generate = typename Gen::template generate<
+			        typename seed::template with_size<unsigned(uint64_t(seed::size) * num / den)>>;
+		};
 
-			template <typename T>
-			using get_seed = typename T::next_seed;
+		namespace detail {
+			/// the generated values of a list, and the budget hits of all of them together
+			template <typename seed, template <typename...> class ResultList, unsigned hits,
+			          typename... Results>
+			using collect = gen_result<seed, ResultList<typename Results::type...>,
+			                           hits + mc::detail::sum({Results::hits...})>;
+
+			/// the share of each of count elements, that evenly divide what is left of the budget
+			/// after the list itself used some nodes and levels of it
+			template <typename Budget, unsigned count, unsigned used>
+			using share = budget<(Budget::nodes > used ? Budget::nodes - used : 0) /
+			                             (count ? count : 1),
+			                     (Budget::depth > used ? Budget::depth - used : 0)>;
+
+			template <typename seed, template <typename...> class ResultList, unsigned used,
+			          typename Indices, typename... Ts>
+			struct generate_all_impl;
+			template <typename seed, template <typename...> class ResultList, unsigned used,
+			          std::size_t... Indices, typename... Ts>
+			struct generate_all_impl<seed, ResultList, used, std::index_sequence<Indices...>,
+			                         Ts...> {
+				using element_budget = share<typename seed::budget, sizeof...(Ts), used>;
+
+				using f = collect<typename seed::next, ResultList, 0,
+				                  typename Ts::template generate<typename seed::template split<
+				                          Indices, element_budget>>...>;
+			};
 
-			template <typename C>
-			struct get_last {
-				template <typename... Ts>
-				using f = mpl::call<mpl::at<mpl::uint_<(sizeof...(Ts) - 1)>, C>, Ts...>;
+			/// generate every element with its own split of the seed, so no element depends on
+			/// the seed that the element before it left behind and the whole list is generated in
+			/// a single pack expansion; the list itself uses used nodes and levels of the budget,
+			/// none for the parameters of a test
+			template <typename seed, template <typename...> class ResultList, unsigned used,
+			          typename... Ts>
+			using generate_all =
+			        typename generate_all_impl<seed, ResultList, used,
+			                                   std::index_sequence_for<Ts...>, Ts...>::f;
+
+			/// the number of elements of a list of n elements that fit in the budget; the list
+			/// takes a node and a level for itself and every element takes at least one node
+			constexpr unsigned fitting_length(unsigned n, unsigned nodes, unsigned depth) {
+				return depth == 0 || nodes < 2 ? 0 : n < nodes - 1 ? n : nodes - 1;
+			}
+
+			template <typename seed, typename Gen, typename Indices, unsigned hits>
+			struct generate_n_impl;
+			template <typename seed, typename Gen, std::size_t... Indices, unsigned hits>
+			struct generate_n_impl<seed, Gen, std::index_sequence<Indices...>, hits> {
+				using element_budget = share<typename seed::budget, sizeof...(Indices), 1>;
+
+				using f = collect<typename seed::next, value::list_of, hits,
+				                  typename Gen::template generate<typename seed::template split<
+				                          Indices, element_budget>>...>;
 			};
 
-			template <typename seed, template <typename...> class ResultList>
-			using generate_all = mc::mpl::fold_transform<
-			        gen_result<seed, void>, mpl::cfe<gen_func>,
-			        mpl::fork<
-			                // add the original seed to the front in case the list is empty
-			                mpl::push_front<gen_result<seed, void>,
-			                                // get the seed of the last generated element
-			                                get_last<mpl::cfe<get_seed>>>,
-			                mpl::transform<mpl::cfe<get_type>, mpl::cfe<ResultList>>,
-			                mpl::cfe<gen_result>>>;
+			/// generate n elements from the same generator, each with its own split of the seed;
+			/// the list is cut short when it does not fit in the budget of the seed
+			template <typename seed, typename Gen, unsigned n,
+			          unsigned length = fitting_length(n, seed::budget::nodes,
+			                                           seed::budget::depth)>
+			using generate_n = typename generate_n_impl<seed, Gen, std::make_index_sequence<length>,
+			                                            (length < n)>::f;
 		} // namespace detail
 
 		template <typename... Ts>
 		struct list {
 			template <typename seed>
-			using generate = mpl::call<typename detail::generate_all<seed, value::list>, Ts...>;
+			using generate = detail::generate_all<seed, value::list, 1, Ts...>;
 		};
 
 		template <typename Gen, typename N = uint_<256>>
 		struct list_of {
 			template <typename seed>
-			using generate = mc::mpl::repeat<
-			        N::template generate<seed>::type::type::value, Gen,
-			        detail::generate_all<typename N::template generate<seed>::next_seed,
-			                             value::list_of>>;
+			using generate = detail::generate_n<typename N::template generate<seed>::next_seed, Gen,
+			                                    N::template generate<seed>::type::type::value>;
 		};
 
 		namespace detail {
@@ -187,8 +237,9 @@ namespace mc {
 			        just<detail::inconstructible>, just<detail::func_wrap_t<detail::foo_func>>,
 			        just<detail::func_wrap_t_ptr_t<nullptr>>,
 
-			        // anything can also be a list of anything, or a list of a list of anything
-			        list_of<anything, uint_<5>>>::template generate<seed>;
+			        // anything can also be a list of anything, or a list of a list of anything;
+			        // every level of nesting halves the size, so deeper lists are shorter
+			        scale<list_of<anything, uint_<5>>, 1, 2>>::template generate<seed>;
 		};
 	} // namespace gen
 
@@ -277,4 +328,56 @@ namespace mc {
 			using type = detail::shrink_any<mpl::cfe<value::list>, Ts...>;
 		};
 	} // namespace gen
+
+	// value statistics, how large the generated values are
+	namespace gen {
+		namespace detail {
+			/// the statistics of several values together
+			template <typename... Stats>
+			struct combined_stats {
+				constexpr static unsigned nodes        = mc::detail::sum({Stats::nodes...});
+				constexpr static unsigned depth        = mc::detail::max_of({Stats::depth...});
+				constexpr static unsigned lists        = mc::detail::sum({Stats::lists...});
+				constexpr static unsigned total_length = mc::detail::sum({Stats::total_length...});
+				constexpr static unsigned min_length   = mc::detail::min_of({Stats::min_length...});
+				constexpr static unsigned max_length   = mc::detail::max_of({Stats::max_length...});
+			};
+
+			/// the statistics of a list of length elements, with the elements combined
+			template <unsigned length, typename Elements>
+			struct list_stats {
+				constexpr static unsigned nodes        = Elements::nodes + 1;
+				constexpr static unsigned depth        = Elements::depth + 1;
+				constexpr static unsigned lists        = Elements::lists + 1;
+				constexpr static unsigned total_length = Elements::total_length + length;
+				constexpr static unsigned min_length =
+				        length < Elements::min_length ? length : Elements::min_length;
+				constexpr static unsigned max_length =
+				        length > Elements::max_length ? length : Elements::max_length;
+			};
+		} // namespace detail
+
+		/// the number of nodes (values and lists) of a value, the depth of its nested lists, and
+		/// the number of lists with their total, minimum and maximum length
+		template <typename T>
+		struct stats {
+			constexpr static unsigned nodes        = 1;
+			constexpr static unsigned depth        = 0;
+			constexpr static unsigned lists        = 0;
+			constexpr static unsigned total_length = 0;
+			constexpr static unsigned min_length   = std::numeric_limits<unsigned>::max();
+			constexpr static unsigned max_length   = 0;
+		};
+
+		template <typename T, typename Seed, typename... Ts>
+		struct stats<value::any<T, Seed, Ts...>> : stats<T> {};
+
+		template <typename... Ts>
+		struct stats<value::list_of<Ts...>>
+		        : detail::list_stats<sizeof...(Ts), detail::combined_stats<stats<Ts>...>> {};
+
+		template <typename... Ts>
+		struct stats<value::list<Ts...>>
+		        : detail::list_stats<sizeof...(Ts), detail::combined_stats<stats<Ts>...>> {};
+	} // namespace gen
 }; // namespace mc
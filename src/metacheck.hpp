@@ -2,433 +2,651 @@
 // Distributed under the Boost Software License, Version 1.0.
 //    (See accompanying file LICENSE.md or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
+
+// everything a test translation unit needs: the tests are checked while compiling, and their
+// results are plain constants; the test runner, which prints them, is in runner.hpp
 #pragma once
 
-#include <iostream>
-#include <string>
+#include <cstdint>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
+#include "config.hpp"
+#include "core.hpp"
+#include "ctest.hpp"
+#include "filter.hpp"
 #include "generators.hpp"
 #include "random.hpp"
+#include "regressions.hpp"
+#include "report.hpp"
+#include "reproduce.hpp"
+#include "shard.hpp"
+#include "type_name.hpp"
 #include "utility.hpp"
 
 namespace mc {
-	namespace kmpl = kvasir::mpl;
-
 	namespace detail {
-		template <template <typename...> class Func, typename seed, typename Result>
-		struct call_generated_result {
-			/// the result of the function being called with the generated parameters
-			using result = mc::mpl::call<Func, typename Result::type>;
-			/// the next seed that should be used when it is wanted to generate more numbers
-			using next_seed = seed;
-			/// the parameters that were used in the function call; can be any list type
-			using parameters = Result;
+		/// the statistics of the parameters of a single try
+		template <typename Params>
+		struct parameter_stats;
+		template <typename... Params>
+		struct parameter_stats<gen::value::list<Params...>>
+		        : gen::detail::combined_stats<gen::stats<Params>...> {};
+
+		/// the statistics of the parameters of all the tries of a test
+		template <typename... Tries>
+		struct tries_stats {
+			constexpr static unsigned min_nodes   = min_of({Tries::nodes...});
+			constexpr static unsigned max_nodes   = max_of({Tries::nodes...});
+			constexpr static unsigned total_nodes = sum({Tries::nodes...});
+
+			constexpr static unsigned min_depth   = min_of({Tries::depth...});
+			constexpr static unsigned max_depth   = max_of({Tries::depth...});
+			constexpr static unsigned total_depth = sum({Tries::depth...});
+
+			constexpr static unsigned lists        = sum({Tries::lists...});
+			constexpr static unsigned min_length   = min_of({Tries::min_length...});
+			constexpr static unsigned max_length   = max_of({Tries::max_length...});
+			constexpr static unsigned total_length = sum({Tries::total_length...});
 		};
 
-		template <template <typename...> class Func, typename Result>
-		using call_generated_impl =
-		        call_generated_result<Func, typename Result::next_seed, typename Result::type>;
-
-		template <template <typename...> class Func, typename seed, typename... Params>
-		using call_generated =
-		        call_generated_impl<Func, typename gen::list<Params...>::template generate<seed>>;
-
-		// virtual base class so that you can use multiple translation units
+		/// the try_record of all the tries of a test; only holds numbers so the name of the
+		/// result type stays short
+		template <unsigned tries, unsigned hits, unsigned min_nodes, unsigned total_nodes,
+		          unsigned max_nodes, unsigned min_depth, unsigned total_depth,
+		          unsigned max_depth, unsigned lists, unsigned min_length, unsigned total_length,
+		          unsigned max_length>
+		struct try_summary {
+			constexpr static try_record record() {
+				return {tries,     hits,        min_nodes, total_nodes,
+				        max_nodes, min_depth,   total_depth, max_depth,
+				        lists,     min_length, total_length, max_length};
+			}
+		};
 
-		template <template <typename...> class FuncName, unsigned failnum, unsigned tries,
-		          unsigned shrinks, typename seed, typename... Params>
+		template <unsigned tries, unsigned hits, typename Stats>
+		using make_summary =
+		        try_summary<tries, hits, Stats::min_nodes, Stats::total_nodes,
+		                    Stats::max_nodes, Stats::min_depth, Stats::total_depth,
+		                    Stats::max_depth, Stats::lists, Stats::min_length,
+		                    Stats::total_length, Stats::max_length>;
+
+		/// the result of a failed test
+		template <template <typename...> class FuncName, unsigned failnum, bool replayed,
+		          unsigned tries, unsigned shrinks, unsigned candidates, bool partial,
+		          typename Summary, uint64_t test_key, uint64_t id, typename seed,
+		          typename... Params>
 		struct error {
 			using next_seed = seed;
 
 			// return a failure when evaluated
 			constexpr static bool value = false;
 
-			template <typename Ostream>
-			auto &&print(Ostream &&stream, std::string &suite) const {
-				std::string name{func_name<FuncName>{}};
-
-				stream << "[ RUN      ] " << suite << name << std::endl
-				       << "Failure after " << (tries - failnum) << "/" << tries << " tries and "
-				       << shrinks << " shrinks." << std::endl
-				       << "Result: " << std::string(type_name<FuncName<Params...>>{}) << std::endl
-				       << "Parameters:";
-				print_all(stream, "\n\t", std::string(type_name<Params>{})...) << std::endl;
-				stream << "[  FAILED  ] " << suite << name << " (0 ms)" << std::endl;
-				return stream;
-			}
-
-			constexpr unsigned num_tests() const {
-				return 1;
-			}
-
-			constexpr unsigned num_passed() const {
-				return 0;
-			}
-
-			constexpr unsigned num_failed() const {
-				return 1;
-			}
+			constexpr static test_report report = {test_name<FuncName>(),
+			                                       true,
+			                                       failnum,
+			                                       replayed,
+			                                       tries,
+			                                       shrinks,
+			                                       candidates,
+			                                       partial,
+			                                       Summary::record(),
+			                                       test_key,
+			                                       id,
+			                                       type_name<FuncName<Params...>>(),
+			                                       type_names<Params...>::value,
+			                                       sizeof...(Params)};
 		};
+		template <template <typename...> class FuncName, unsigned failnum, bool replayed,
+		          unsigned tries, unsigned shrinks, unsigned candidates, bool partial,
+		          typename Summary, uint64_t test_key, uint64_t id, typename seed,
+		          typename... Params>
+		constexpr test_report error<FuncName, failnum, replayed, tries, shrinks, candidates,
+		                            partial, Summary, test_key, id, seed, Params...>::report;
 
-		template <unsigned failnum, unsigned tries, unsigned shrinks, typename Result>
+		template <unsigned failnum, bool replayed, unsigned tries, unsigned shrinks,
+		          unsigned candidates, bool partial, typename Summary, uint64_t test_key,
+		          uint64_t id, typename Result>
 		struct make_error;
-		template <unsigned failnum, unsigned tries, unsigned shrinks,
-		          template <typename...> class FuncName, typename seed, typename... Params>
-		struct make_error<failnum, tries, shrinks,
+		template <unsigned failnum, bool replayed, unsigned tries, unsigned shrinks,
+		          unsigned candidates, bool partial, typename Summary, uint64_t test_key,
+		          uint64_t id, template <typename...> class FuncName, typename seed,
+		          typename... Params>
+		struct make_error<failnum, replayed, tries, shrinks, candidates, partial, Summary,
+		                  test_key, id,
 		                  call_generated_result<FuncName, seed, gen::value::list<Params...>>> {
-			using f = error<FuncName, failnum, tries, shrinks, seed, typename Params::type...>;
+			using f = error<FuncName, failnum, replayed, tries, shrinks, candidates, partial,
+			                Summary, test_key, id, seed, typename Params::type...>;
 		};
 
-		template <template <typename...> class FuncName, unsigned tries, typename seed>
+		/// the result of a test that passed
+		template <template <typename...> class FuncName, unsigned tries, typename seed,
+		          typename Summary>
 		struct pass {
 			using next_seed = seed;
 
 			// return a success when evaluated
 			constexpr static bool value = true;
 
-			template <typename Ostream>
-			auto &&print(Ostream &&stream, std::string &suite) const {
-				std::string name = func_name<FuncName>{};
-
-				stream << "[ RUN      ] " << suite << name << std::endl
-				       << "[       OK ] " << suite << name << " (0 ms)" << std::endl;
-				return stream;
-			}
-
-			constexpr unsigned num_tests() const {
-				return 1;
-			}
-
-			constexpr unsigned num_passed() const {
-				return 1;
-			}
-
-			constexpr unsigned num_failed() const {
-				return 0;
-			}
+			constexpr static test_report report = {
+			        test_name<FuncName>(), false, 0, false, tries, 0, 0, false, Summary::record(),
+			        0, 0, {nullptr, 0, 0}, nullptr, 0};
 		};
+		template <template <typename...> class FuncName, unsigned tries, typename seed,
+		          typename Summary>
+		constexpr test_report pass<FuncName, tries, seed, Summary>::report;
 
-		template <typename Params, unsigned shrinks>
-		struct minify_result {
-			using parameters                        = Params;
-			constexpr static unsigned total_shrinks = shrinks;
-		};
-
-		template <template <typename...> class Func, unsigned shrinks = 0>
-		struct minify {
-			// find a test that also fails the function
-			template <typename Params>
-			using call_pred = kmpl::bool_<(!mpl::call<Func, typename Params::type>::value)>;
-
-			template <typename Params>
-			using f = typename kmpl::call<
-			        kmpl::unpack<kmpl::find_if<kmpl::cfe<call_pred>,
-			                                   kmpl::front<minify<Func, shrinks + 1>>,
-			                                   kmpl::always<minify_result<Params, shrinks>>>>,
-			        typename gen::shrink<Params>::type>;
-		};
-
-		enum check_state { PASS, FAIL, RECURSE };
-
-		constexpr check_state check_select(unsigned tries, bool pass = true) {
-			return pass ? (tries == 0 ? PASS : RECURSE) : FAIL;
-		}
-
-		template <check_state>
+		/// the result of a test of which the try failnum failed or not; replayed tells whether
+		/// that try was a replayed regression instead of a random try
+		template <bool failed>
 		struct check_impl;
 		template <>
-		struct check_impl<PASS> {
-			template <template <typename...> class Func, unsigned tries, unsigned total_tries,
-			          typename Result, typename... Params>
-			using f = pass<Func, total_tries, typename Result::next_seed>;
+		struct check_impl<false> {
+			template <typename Config, template <typename...> class Func, unsigned failnum,
+			          bool replayed, unsigned tries, typename Summary, typename seed,
+			          typename... Params>
+			using f = pass<Func, tries, typename seed::template split<tries>, Summary>;
 		};
 		template <>
-		struct check_impl<FAIL> {
+		struct check_impl<true> {
 			template <typename MinifyResult>
 			struct with_minify_result {
-				template <template <typename...> class Func, unsigned tries, unsigned total_tries,
-				          typename Result>
+				template <template <typename...> class Func, unsigned failnum, bool replayed,
+				          unsigned tries, typename Summary, typename seed, uint64_t id>
 				using f = typename make_error<
-				        tries, total_tries, MinifyResult::total_shrinks,
-				        call_generated_result<Func, typename Result::next_seed,
+				        failnum + 1, replayed, tries, MinifyResult::total_shrinks,
+				        MinifyResult::total_candidates, MinifyResult::partially_shrunk, Summary,
+				        seed::key, id,
+				        call_generated_result<Func, typename seed::template split<tries>,
 				                              typename MinifyResult::parameters>>::f;
 			};
 
-			template <template <typename...> class Func, unsigned tries, unsigned total_tries,
-			          typename Result, typename... Params>
-			using f = typename with_minify_result<typename minify<Func>::template f<
-			        typename Result::parameters>>::template f<Func, tries, total_tries, Result>;
-		};
-		template <>
-		struct check_impl<RECURSE> {
-			template <template <typename...> class Func, unsigned tries, unsigned total_tries,
-			          typename Result, typename... Params>
-			using f = typename check_impl<check_select(
-			        tries - 1,
-			        call_generated<Func, typename Result::next_seed, Params...>::result::value)>::
-			        template f<Func, tries - 1, total_tries,
-			                   call_generated<Func, typename Result::next_seed, Params...>,
-			                   Params...>;
+			template <typename Config, template <typename...> class Func, unsigned failnum,
+			          bool replayed, unsigned tries, typename Summary, typename seed,
+			          typename... Params>
+			using f = typename with_minify_result<typename shrink_all<
+			        Config, Func,
+			        typename call_generated<Func, try_seed<Config, seed, failnum, tries>,
+			                                Params...>::parameters>::type>::
+			        template f<Func, failnum, replayed, tries, Summary, seed,
+			                   test_id<test<Config, Func, tries, Params...>>()>;
 		};
 
-		template <template <typename...> class Func, unsigned tries, typename seed,
-		          typename... Params>
-		using check = typename detail::check_impl<detail::check_select(tries)>::template f<
-		        Func, tries + 1, tries,
-		        detail::call_generated_result<kmpl::list, seed, gen::value::list<>>, Params...>;
-
-		template <template <typename...> class Func, unsigned tries, typename... Params>
-		struct test {};
-
-		/// single section consisting of multiple tests
-		template <typename... Tests>
-		struct section {
-			const char *name; // pod type constructor
-			std::tuple<Tests...> tests;
+		/// run the tries from first on, out of a test of the given number of tries
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, unsigned first, typename Tries, typename... Params>
+		struct check_tries;
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, unsigned first, std::size_t... Tries, typename... Params>
+		struct check_tries<Config, Func, tries, seed, first, std::index_sequence<Tries...>,
+		                   Params...> {
+			template <std::size_t try_num>
+			using generated = call_generated<Func, try_seed<Config, seed, first + try_num, tries>,
+			                                 Params...>;
+
+			// every try is generated and called in a single pack expansion, so the nesting depth
+			// of a check does not grow with the number of tries
+			constexpr static unsigned failed =
+			        first_failure({generated<Tries>::result::value...});
+
+			using summary =
+			        make_summary<sizeof...(Tries), sum({generated<Tries>::hits...}),
+			                     tries_stats<parameter_stats<
+			                             typename generated<Tries>::parameters>...>>;
+
+			using f = typename check_impl<(failed < sizeof...(Tries))>::template f<
+			        Config, Func, first + failed, false, tries, summary, seed, Params...>;
 		};
-	} // namespace detail
-
-	/// a single test case testing a function
-	/// \tparam Func the function that is to be tested, should be convertible to bool, true if
-	///             the test passed, and false if the test failed
-	/// \tparam tries the number of times the function should be tried with different parameters
-	/// \tparam Params the parameter generators that create the parameters to be passed into the
-	///             function
-	template <template <typename...> class Func, unsigned tries, typename... Params>
-	constexpr detail::test<Func, tries, Params...> test{};
 
-	template <typename... Tests>
-	constexpr detail::section<Tests...> section(const char *name, const Tests... tests) {
-		return {.name = name, .tests = std::make_tuple(tests...)};
-	}
-
-	namespace detail {
-		struct section_base {
-			const char *name;
-
-			constexpr section_base(const char *name) : name{name} {};
+		template <bool failed>
+		struct replay_impl;
+		template <>
+		struct replay_impl<false> {
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename seed, typename Replays, unsigned failed, typename Summary,
+			          typename... Params>
+			using f = typename check_tries<
+			        Config, Func, tries, seed, shard_begin(tries, METACHECK_SHARD),
+			        std::make_index_sequence<shard_begin(tries, METACHECK_SHARD + 1) -
+			                                 shard_begin(tries, METACHECK_SHARD)>,
+			        Params...>::f;
+		};
+		template <>
+		struct replay_impl<true> {
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename seed, typename Replays, unsigned failed, typename Summary,
+			          typename... Params>
+			using f = typename check_impl<true>::template f<
+			        Config, Func, Replays::template replay_try<failed>::value, true, tries,
+			        Summary, typename Replays::template replay_seed<failed>, Params...>;
+		};
 
-			virtual unsigned num_tests() const                                              = 0;
-			virtual unsigned num_failed() const                                             = 0;
-			virtual unsigned num_passed() const                                             = 0;
-			virtual std::ostream &print(std::ostream &stream, std::string &test_root) const = 0;
+		/// replay the regressions of a test in the section with the given key before its random
+		/// tries; a failing regression is shrunk and reported like any other failure
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, uint64_t section, typename Replays, typename... Params>
+		struct check_replays;
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, uint64_t section, std::size_t... Replays, typename... Params>
+		struct check_replays<Config, Func, tries, seed, section, std::index_sequence<Replays...>,
+		                     Params...> {
+			constexpr static uint64_t id = test_id<test<Config, Func, tries, Params...>>();
+
+			template <std::size_t index>
+			using replay_seed = seed_state<regression_at<Func>(id, section, index).seed>;
+
+			template <std::size_t index>
+			using replay_try =
+			        std::integral_constant<unsigned,
+			                               regression_at<Func>(id, section, index).try_num>;
+
+			template <std::size_t index>
+			using generated = call_generated<
+			        Func, try_seed<Config, replay_seed<index>, replay_try<index>::value, tries>,
+			        Params...>;
+
+			constexpr static unsigned failed =
+			        first_failure({generated<Replays>::result::value...});
+
+			using summary =
+			        make_summary<sizeof...(Replays), sum({generated<Replays>::hits...}),
+			                     tries_stats<parameter_stats<
+			                             typename generated<Replays>::parameters>...>>;
+
+			using f = typename replay_impl<(failed < sizeof...(Replays))>::template f<
+			        Config, Func, tries, seed, check_replays, failed, summary, Params...>;
 		};
 
-		template <typename Result>
-		auto &&print_result(std::ostream &stream, std::string &section, Result &result) {
-			return deref(result).print(stream, section);
-		}
+#ifdef METACHECK_REPRODUCE
+		// only the reproduced try, generated from the reproduced seed instead of the seed that
+		// the test gets in its section
+		template <uint64_t section, typename Config, template <typename...> class Func,
+		          unsigned tries, typename seed, typename... Params>
+		using check = typename check_tries<Config, Func, tries, reproduce_seed, reproduce_try,
+		                                   std::index_sequence<0>, Params...>::f;
+#else
+		template <uint64_t section, typename Config, template <typename...> class Func,
+		          unsigned tries, typename seed, typename... Params>
+		using check = typename check_replays<
+		        Config, Func, tries, seed, section,
+		        // only the first shard replays the regressions
+		        std::make_index_sequence<(
+		                METACHECK_SHARD == 0
+		                        ? regression_count<Func>(
+		                                  test_id<test<Config, Func, tries, Params...>>(), section)
+		                        : 0)>,
+		        Params...>::f;
+#endif
+
+		/// the item of a test in the section with the given key
+		template <bool selected>
+		struct test_item {
+			// leave the test out without instantiating its check
+			template <uint64_t section, typename Config, template <typename...> class Func,
+			          unsigned tries, typename... Params>
+			constexpr static section_item f() {
+				return {nullptr, nullptr};
+			}
+		};
+		template <>
+		struct test_item<true> {
+			template <uint64_t section, typename Config, template <typename...> class Func,
+			          unsigned tries, typename... Params>
+			constexpr static section_item f() {
+				return {&check<section, Config, Func, tries,
+				               test_seed<test<Config, Func, tries, Params...>>, Params...>::report,
+				        nullptr};
+			}
+		};
 
-		template <typename Results, std::size_t... Ints>
-		auto &&print_all_tuple_impl(std::ostream &stream, std::string &section,
-		                            const Results results, const std::index_sequence<Ints...>) {
-			// return the last result from the print functions
-			return std::get<sizeof...(Ints)>(std::forward_as_tuple(
-			        stream, print_result(stream, section, std::get<Ints>(results))...));
+		/// replay the regressions of a constexpr test, up to the first one that fails
+		template <typename Config, typename Prop, unsigned tries, typename Params>
+		constexpr cresult<Params> ccheck_replays(string_part name, uint64_t id, uint64_t section) {
+			cresult<Params> replays{false, 0, 0, 0, 0, false, {}, {}};
+			// only the first shard replays the regressions
+			for (unsigned i = 0; METACHECK_SHARD == 0 && i < regression_count(name, id, section);
+			     ++i) {
+				regression r           = regression_at(name, id, section, i);
+				cresult<Params> replay = ccheck_tries<Config, Prop, Params>(r.seed, r.try_num,
+				                                                           r.try_num + 1, tries);
+				replays.summary        = combine(replays.summary, replay.summary);
+				if (replay.failed) {
+					replay.summary = replays.summary;
+					return replay;
+				}
+			}
+			return replays;
 		}
 
-		template <typename Results>
-		auto print_all_tuple(std::ostream &stream, std::string section, const Results results)
-		        -> decltype(print_all_tuple_impl(
-		                stream, section, results,
-		                std::make_index_sequence<std::tuple_size<Results>::value>{})) {
-			return print_all_tuple_impl(
-			        stream, section, results,
-			        std::make_index_sequence<std::tuple_size<Results>::value>{});
+		/// the result of a constexpr test in the section with the given key, and the text of its
+		/// counterexample
+		template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		struct crun {
+			using params = cparams<Gens...>;
+
+#ifdef METACHECK_REPRODUCE
+			// only the reproduced try, generated from the reproduced seed
+			constexpr static cresult<params> unshrunk =
+			        ctries<Config, Prop, params, reproduce_seed::key, tries, reproduce_try,
+			               reproduce_try + 1>::value;
+
+			constexpr static bool replayed_failure = false;
+#else
+			constexpr static cresult<params> replayed =
+			        ccheck_replays<Config, Prop, tries, params>(
+			                ctest_name<Prop>(), test_id<ctest<Config, Prop, tries, Gens...>>(),
+			                section);
+
+			// the random tries in the range of the shard, unless a regression failed
+			constexpr static cresult<params> unshrunk =
+			        replayed.failed
+			                ? replayed
+			                : ctries<Config, Prop, params,
+			                         test_seed<ctest<Config, Prop, tries, Gens...>>::key, tries,
+			                         shard_begin(tries, METACHECK_SHARD),
+			                         shard_begin(tries, METACHECK_SHARD + 1)>::value;
+
+			/// whether the failure is one of the replayed regressions
+			constexpr static bool replayed_failure = replayed.failed;
+#endif
+
+			constexpr static cresult<params> result =
+			        unshrunk.failed ? cshrink<Config, Prop>(unshrunk) : unshrunk;
+
+			constexpr static unsigned length = params_length(result.params) + 1;
+			constexpr static ctext<length, sizeof...(Gens)> text =
+			        print_params<length, sizeof...(Gens)>(result.params);
 		};
-
-		template <typename Results>
-		class section_result : public section_base {
-		public:
-			const Results results;
-
-			constexpr section_result(const Results results, const char *name)
-			    : section_base{name}, results{results} {
+		template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		constexpr cresult<cparams<Gens...>> crun<section, Config, Prop, tries, Gens...>::result;
+		template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		constexpr ctext<crun<section, Config, Prop, tries, Gens...>::length, sizeof...(Gens)>
+		        crun<section, Config, Prop, tries, Gens...>::text;
+
+		/// the parameters of the counterexample of Run, as parts of its text
+		template <typename Run, typename Indices>
+		struct cparams_text;
+		template <typename Run, std::size_t... Indices>
+		struct cparams_text<Run, std::index_sequence<Indices...>> {
+			constexpr static string_part value[] = {
+			        {Run::text.data, Run::text.begin(Indices), Run::text.ends[Indices]}...,
+			        {nullptr, 0, 0}};
+		};
+		template <typename Run, std::size_t... Indices>
+		constexpr string_part cparams_text<Run, std::index_sequence<Indices...>>::value[];
+
+		/// the report of a constexpr test
+		template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		struct ccheck {
+			using run = crun<section, Config, Prop, tries, Gens...>;
+
+			constexpr static test_report report = {
+			        ctest_name<Prop>(),
+			        run::result.failed,
+			        run::result.failnum,
+			        run::replayed_failure,
+			        tries,
+			        run::result.shrinks,
+			        run::result.candidates,
+			        run::result.partial,
+			        run::result.summary,
+			        run::result.key,
+			        run::result.failed ? test_id<ctest<Config, Prop, tries, Gens...>>() : 0,
+			        {"false", 0, run::result.failed ? 5u : 0u},
+			        cparams_text<run, std::index_sequence_for<Gens...>>::value,
+			        run::result.failed ? unsigned(sizeof...(Gens)) : 0u};
+		};
+		template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		constexpr test_report ccheck<section, Config, Prop, tries, Gens...>::report;
+
+		template <bool selected>
+		struct ctest_item {
+			// leave the test out without running its tries
+			template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+			constexpr static section_item f() {
+				return {nullptr, nullptr};
 			}
-
-			//			constexpr static auto num_tests = std::tuple_size<Results>::value;
-			unsigned num_tests() const override {
-				return std::tuple_size<Results>::value;
+		};
+		template <>
+		struct ctest_item<true> {
+			template <uint64_t section, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+			constexpr static section_item f() {
+				return {&ccheck<section, Config, Prop, tries, Gens...>::report, nullptr};
 			}
+		};
 
-			unsigned num_passed() const override {
-				unsigned passed = 0;
-				foreach
-					<void>(results, [&](auto result) { passed += deref(result).num_passed(); });
-				return passed;
-			}
-			unsigned num_failed() const override {
-				unsigned failed = 0;
-				foreach
-					<void>(results, [&](auto result) { failed += deref(result).num_failed(); });
-				return failed;
+		/// a test as an item of any section
+		template <bool selected, typename Config, template <typename...> class Func,
+		          unsigned tries, typename... Params>
+		struct test_in_sections {
+			constexpr static uint64_t id = test_id<test<Config, Func, tries, Params...>>();
+
+			/// the number of sections that recorded regressions of the test
+			constexpr static unsigned count =
+			        selected && METACHECK_SHARD == 0 ? regression_section_count<Func>(id) : 0;
+
+			constexpr static uint64_t key_at(unsigned index) {
+				return regression_section_at<Func>(id, index);
 			}
 
-			std::ostream &print(std::ostream &stream, std::string &test_root) const override {
-				std::string new_root{test_root};
-				new_root.append(name).append(".");
-				// replace the root name with the current section for now
-				stream << "[----------] " << num_tests() << " tests from " << name << std::endl;
-				print_all_tuple(stream, new_root, results);
-				stream << "[----------] " << num_tests() << " tests from " << name
-				       << " (0 ms total)" << std::endl;
-				return stream;
+			template <uint64_t key>
+			constexpr static section_item item() {
+				return test_item<selected>::template f<key, Config, Func, tries, Params...>();
 			}
 		};
 
-		template <typename Results, typename Seed>
-		struct section_temp {
-			const Results results;
-			const char *name;
+		/// a constexpr test as an item of any section
+		template <bool selected, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		struct ctest_in_sections {
+			constexpr static uint64_t id = test_id<ctest<Config, Prop, tries, Gens...>>();
+
+			/// the number of sections that recorded regressions of the test
+			constexpr static unsigned count =
+			        selected && METACHECK_SHARD == 0
+			                ? regression_section_count(ctest_name<Prop>(), id)
+			                : 0;
 
-			using next_seed = Seed;
+			constexpr static uint64_t key_at(unsigned index) {
+				return regression_section_at(ctest_name<Prop>(), id, index);
+			}
 
-			constexpr const section_result<Results> make_result_struct() const {
-				return {results, name};
+			template <uint64_t key>
+			constexpr static section_item item() {
+				return ctest_item<selected>::template f<key, Config, Prop, tries, Gens...>();
 			}
 		};
 
-		template <typename Seed>
-		constexpr section_temp<std::tuple<>, Seed> empty_section_result(const char *name) {
-			return {.results = {}, .name = name};
+		/// the item of a test in a section of which the name is only known at run time, as the
+		/// sections passed to test_all; the test is checked with the regressions of every section
+		/// that recorded some of them, and once without any, and the item of the section with
+		/// the given key is picked at run time. the random tries are the same in all of them, so
+		/// they are only instantiated once
+		template <typename Item, typename Sections = std::make_index_sequence<Item::count>>
+		struct item_in_section;
+		template <typename Item, std::size_t... Sections>
+		struct item_in_section<Item, std::index_sequence<Sections...>> {
+			constexpr static uint64_t keys[] = {Item::key_at(Sections)..., no_section};
+			constexpr static section_item items[] = {
+			        Item::template item<Item::key_at(Sections)>()...,
+			        Item::template item<no_section>()};
+
+			static section_item f(uint64_t section) {
+				unsigned index = 0;
+				while (index < sizeof...(Sections) && keys[index] != section) {
+					++index;
+				}
+				return items[index];
+			}
+		};
+		template <typename Item, std::size_t... Sections>
+		constexpr uint64_t item_in_section<Item, std::index_sequence<Sections...>>::keys[];
+		template <typename Item, std::size_t... Sections>
+		constexpr section_item item_in_section<Item, std::index_sequence<Sections...>>::items[];
+
+		template <typename Section>
+		constexpr const Section &section_at(const Section &section, std::index_sequence<>) {
+			return section;
 		}
 
-		template <typename State>
-		constexpr const State test_all_func(const State state) {
-			return state;
+		/// the section nested in section at the path of indices
+		template <typename Section, std::size_t index, std::size_t... path>
+		constexpr const auto &section_at(const Section &section,
+		                                 std::index_sequence<index, path...>) {
+			return section_at(std::get<index>(section.tests), std::index_sequence<path...>{});
 		}
 
-		template <typename State, typename TestResult>
-		constexpr auto push_test_result(const State state, TestResult result)
-		        -> section_temp<decltype(std::tuple_cat(state.results,
-		                                                std::tuple<TestResult>{result})),
-		                        typename TestResult::next_seed> {
-			return {std::tuple_cat(state.results, std::tuple<TestResult>{result}), state.name};
+		template <typename Section>
+		constexpr uint64_t path_hash(const Section &, uint64_t hash, std::index_sequence<>) {
+			return hash;
 		}
 
-		// test a single test
-		template <typename State, template <typename...> class Func, unsigned tries,
-		          typename... Params, typename... Tests>
-		constexpr auto test_all_func(const State state, const test<Func, tries, Params...> test,
-		                             const Tests... tests)
-		        -> decltype(test_all_func(
-		                push_test_result(
-		                        state,
-		                        detail::check<Func, tries, typename State::next_seed, Params...>{}),
-		                tests...)) {
-			return test_all_func(
-			        push_test_result(state,
-			                         check<Func, tries, typename State::next_seed, Params...>{}),
-			        tests...);
+		/// the hash of the full name of the section at path in section, continued from the hash
+		/// of the full name of section
+		template <typename Section, std::size_t index, std::size_t... path>
+		constexpr uint64_t path_hash(const Section &section, uint64_t hash,
+		                             std::index_sequence<index, path...>) {
+			const char *name = std::get<index>(section.tests).name;
+			return path_hash(std::get<index>(section.tests),
+			                 name_hash({name, 0, string_length(name)}, name_hash({".", 0, 1}, hash)),
+			                 std::index_sequence<path...>{});
 		}
 
-		template <typename State, typename SectionResult>
-		constexpr auto push_section_result(const State state, const SectionResult result)
-		        -> section_temp<
-		                decltype(std::tuple_cat(state.results,
-		                                        std::make_tuple(result.make_result_struct()))),
-		                typename SectionResult::next_seed> {
-			return {.results = std::tuple_cat(state.results,
-			                                  std::make_tuple(result.make_result_struct())),
-			        .name    = state.name};
+		/// the key of the section at path in root for its regressions, from its full name
+		template <typename Root, const Root &root, typename Path>
+		constexpr uint64_t regression_section(Path path) {
+			return section_key(
+			        path_hash(root, name_hash({root.name, 0, string_length(root.name)}), path));
 		}
 
-		template <typename State, typename... Tests, std::size_t... Ints>
-		constexpr auto test_all_tuple_impl(const State state, const std::tuple<Tests...> tests,
-		                                   const std::index_sequence<Ints...>) {
-			return test_all_func(state, std::get<Ints>(tests)...);
-		};
-
-		template <typename State, typename... Tests>
-		constexpr auto test_all_tuple(const State state, const std::tuple<Tests...> tests)
-		        -> decltype(test_all_tuple_impl(state, tests,
-		                                        std::index_sequence_for<Tests...>{})) {
-			return test_all_tuple_impl(state, tests, std::index_sequence_for<Tests...>{});
+		template <typename Root, const Root &root, typename Path,
+		          typename Items = std::make_index_sequence<std::tuple_size<
+		                  std::remove_cv_t<decltype(section_at(root, Path{}).tests)>>::value>>
+		struct section_node;
+
+		/// the item at index of the section at path in root
+		template <uint64_t patterns, typename Root, const Root &root, typename Path,
+		          std::size_t index, typename Item>
+		struct item_of;
+
+		// a single test, when it is selected by the test filter
+		template <uint64_t patterns, typename Root, const Root &root, typename Path,
+		          std::size_t index, typename Config, template <typename...> class Func,
+		          unsigned tries, typename... Params>
+		struct item_of<patterns, Root, root, Path, index, test<Config, Func, tries, Params...>> {
+			constexpr static section_item value() {
+				return test_item<selected<Func>(patterns) &&
+				                 reproduced(test_id<test<Config, Func, tries, Params...>>())>::
+				        template f<regression_section<Root, root>(Path{}), Config, Func, tries,
+				                   Params...>();
+			}
 		};
 
-		// test all the items in a section
-		template <typename State, typename... SectionTests, typename... Tests>
-		constexpr auto test_all_func(const State state, const section<SectionTests...> section,
-		                             const Tests... tests)
-		        -> decltype(test_all_func(
-		                push_section_result(
-		                        state,
-		                        test_all_tuple(empty_section_result<typename State::next_seed>(
-		                                               section.name),
-		                                       section.tests)),
-		                tests...)) {
-			return test_all_func(
-			        push_section_result(
-			                state, test_all_tuple(empty_section_result<typename State::next_seed>(
-			                                              section.name),
-			                                      section.tests)),
-			        tests...);
-		}
-
-		// section_base specific push section
-		template<typename State>
-		constexpr auto push_section_result(const State state,
-		                                   const section_base *result) -> section_temp<
-			decltype(std::tuple_cat(state.results, std::make_tuple(result))),
-			typename State::next_seed> {
-			return {.results = std::tuple_cat(state.results,
-			                                  std::make_tuple(result)), .name    = state.name};
-		}
-
-		// section_base specific test_all impl
-		template<typename State, typename... Tests>
-		constexpr auto test_all_func(const State state, const section_base *result,
-		                             const Tests... tests) -> decltype(test_all_func(
-			push_section_result(state, result), tests...)) {
-			return test_all_func(push_section_result(state, result), tests...);
+		// a single constexpr test, when it is selected by the test filter
+		template <uint64_t patterns, typename Root, const Root &root, typename Path,
+		          std::size_t index, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		struct item_of<patterns, Root, root, Path, index, ctest<Config, Prop, tries, Gens...>> {
+			constexpr static section_item value() {
+				return ctest_item<cselected<Prop>(patterns) &&
+				                  reproduced(test_id<ctest<Config, Prop, tries, Gens...>>())>::
+				        template f<regression_section<Root, root>(Path{}), Config, Prop, tries,
+				                   Gens...>();
+			}
 		};
 
-		template <typename Result>
-		struct result_printer_impl {
-			const Result result;
-
-			constexpr operator int() const {
-				return result.num_failed() == 0 ? 0 : 1;
+		// all the items in a nested section
+		template <uint64_t patterns, typename Root, const Root &root, std::size_t... path,
+		          std::size_t index, typename... Tests>
+		struct item_of<patterns, Root, root, std::index_sequence<path...>, index,
+		               section<Tests...>> {
+			constexpr static section_item value() {
+				return {nullptr,
+				        &section_node<Root, root, std::index_sequence<path..., index>>::value};
 			}
+		};
 
-			friend std::ostream &operator<<(std::ostream &stream,
-			                                const result_printer_impl<Result> lhs) {
-				std::size_t num_suites = std::tuple_size<
-				                    std::remove_reference_t<decltype(result.results)>>::value,
-				            num_tests = lhs.result.num_tests();
-
-				stream << "[==========] Running " << num_tests
-				       << (num_tests == 1 ? " test" : " tests") << " from " << num_suites
-				       << " test " << (num_suites == 1 ? "case." : "cases.") << std::endl
-				       << "Seed: " << random_seed::state << std::endl;
-				print_all_tuple(stream, std::string(""), lhs.result.results);
-				stream << std::endl
-				       << "[----------] Global test environment tear-down" << std::endl
-				       << "[==========] " << num_tests << (num_tests == 1 ? " test" : " tests")
-				       << " from " << num_suites << " test " << (num_suites == 1 ? "case" : "cases")
-				       << " ran. (0 ms total)" << std::endl
-				       << "[  PASSED  ] " << lhs.result.num_passed() << " tests." << std::endl;
-				return stream;
+		// a section that was tested in another translation unit
+		template <uint64_t patterns, typename Root, const Root &root, typename Path,
+		          std::size_t index>
+		struct item_of<patterns, Root, root, Path, index, const section_base *> {
+			constexpr static section_item value() {
+				return {nullptr, std::get<index>(section_at(root, Path{}).tests)};
 			}
 		};
 
-		template <typename Result>
-		constexpr auto result_printer(const Result &&result) {
-			return result_printer_impl<Result>{.result = result};
+		/// the results of the section at path in root, as constants; every item is tested on its
+		/// own, so the items of a section are built in a single pack expansion
+		template <typename Root, const Root &root, std::size_t... path, std::size_t... Items>
+		struct section_node<Root, root, std::index_sequence<path...>,
+		                    std::index_sequence<Items...>> {
+			using tests = std::remove_cv_t<decltype(
+			        section_at(root, std::index_sequence<path...>{}).tests)>;
+
+			/// the filter patterns that apply to the tests of this section; only the name of
+			/// the root section is known when it is compiled
+			constexpr static uint64_t patterns =
+			        sizeof...(path) == 0 ? section_patterns(root.name) : unknown_section_patterns();
+
+			constexpr static section_item items[] = {
+			        item_of<patterns, Root, root, std::index_sequence<path...>, Items,
+			                std::tuple_element_t<Items, tests>>::value()...,
+			        // keeps the array from being empty
+			        {nullptr, nullptr}};
+
+			constexpr static section_result value{
+			        section_at(root, std::index_sequence<path...>{}).name, items,
+			        sizeof...(Items)};
+		};
+		template <typename Root, const Root &root, std::size_t... path, std::size_t... Items>
+		constexpr section_item section_node<Root, root, std::index_sequence<path...>,
+		                                    std::index_sequence<Items...>>::items[];
+		template <typename Root, const Root &root, std::size_t... path, std::size_t... Items>
+		constexpr section_result section_node<Root, root, std::index_sequence<path...>,
+		                                      std::index_sequence<Items...>>::value;
+
+		/// the results of the section root, with its key in the result cache
+		template <typename Root, const Root &root>
+		constexpr section_result precalc_section(const char *key) {
+			return {root.name, section_node<Root, root, std::index_sequence<>>::items,
+			        section_node<Root, root, std::index_sequence<>>::value.count, key};
 		}
 	} // namespace detail
 
-	template <typename... Tests>
-	constexpr auto test_all(const Tests... tests) {
-		return detail::result_printer(
-		        detail::test_all_func(detail::empty_section_result<random_seed>(""), tests...)
-		                .make_result_struct());
-	}
-
-#define PRECALC_SECTION(SECTION)                                                            \
-    mc::detail::test_all_tuple(mc::detail::empty_section_result<FILE_RANDOM>(SECTION.name), \
-                               SECTION.tests)                                               \
-            .make_result_struct()
+// the key of the translation unit in the result cache, defined by the cmake helper that wraps it
+#ifndef METACHECK_CACHE_KEY
+#define METACHECK_CACHE_KEY nullptr
+#endif
+
+// the results of SECTION, which has to be a constexpr variable outside of any function
+#define PRECALC_SECTION(SECTION) \
+    mc::detail::precalc_section<decltype(SECTION), SECTION>(METACHECK_CACHE_KEY)
+
+#define METACHECK_CAT_IMPL(A, B) A##B
+#define METACHECK_CAT(A, B) METACHECK_CAT_IMPL(A, B)
+
+// add the precalculated section RESULT to mc::registered_sections; the shards of a sharded
+// translation unit are not registered, the section that merges them is
+#if METACHECK_SHARDS > 1
+#define METACHECK_REGISTER(RESULT)
+#else
+#define METACHECK_REGISTER(RESULT)                                                   \
+    METACHECK_REGISTRY_ENTRY static const mc::detail::section_base *const            \
+            METACHECK_CAT(metacheck_registered_, __LINE__) = &RESULT
+#endif
+
+// precalculate SECTION, export it as the section_base pointer NAME, which the cmake helpers use to
+// refer to the translation unit, and register it
+#define METACHECK_REGISTER_SECTION(NAME, SECTION)                             \
+    constexpr auto NAME##_result            = PRECALC_SECTION(SECTION);       \
+    const mc::detail::section_base *NAME    = &NAME##_result;                 \
+    METACHECK_REGISTER(NAME##_result)
 } // namespace mc
@@ -0,0 +1,422 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// runs the constexpr tests (mc::ctest) of sections at run time, with far more tries than a
+// compiler could evaluate, on all cores:
+//
+//   std::cout << mc::test_parallel(mc::parallel_config{1000000}, section);
+//
+// the tries of a test are split over the threads as ranges of try numbers; a thread that runs out
+// of tries steals the upper half of the range of another one. run time try t is try t % tries of
+// round t / tries, where tries is the number of tries of the test and every round has a key of its
+// own; round 0 is the same as the tries that are run while compiling, and a failure prints its
+// round and the key and try in that round, so it reproduces while compiling like any other
+// failure. the first failing try is shrunk and reported, whatever the order the threads found
+// failures in
+//
+// include it instead of runner.hpp, in the single translation unit of the runner; the tests over
+// types can only run while compiling, so they are left out
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "runner.hpp"
+
+namespace mc {
+	/// how many tries every constexpr test runs at run time, and on how many threads
+	struct parallel_config {
+		uint64_t tries;
+		unsigned threads = std::thread::hardware_concurrency();
+	};
+
+	namespace detail {
+		/// the key of a round of the tries of a test with the given key; round 0 is the test
+		/// itself
+		constexpr uint64_t round_key(uint64_t key, uint64_t round) {
+			return round == 0 ? key : mix64(key ^ mix64(round * golden_gamma));
+		}
+
+		/// the tries from begin up to end that a thread still has to run
+		struct try_range {
+			std::mutex mutex;
+			uint64_t begin = 0, end = 0;
+		};
+
+		/// hands out the tries of a test to the threads in chunks, and lets a thread that ran out
+		/// steal from the others
+		class try_scheduler {
+			/// the number of tries a thread takes at once, to keep the locking cheap
+			constexpr static uint64_t chunk = 64;
+
+			std::unique_ptr<try_range[]> ranges;
+			unsigned count;
+
+		public:
+			try_scheduler(uint64_t tries, unsigned threads)
+			    : ranges{new try_range[threads]}, count{threads} {
+				for (unsigned i = 0; i < threads; ++i) {
+					ranges[i].begin = tries * i / threads;
+					ranges[i].end   = tries * (i + 1) / threads;
+				}
+			}
+
+			/// the next tries of the thread, false when all tries were handed out
+			bool next(unsigned thread, uint64_t &begin, uint64_t &end) {
+				for (;;) {
+					{
+						std::lock_guard<std::mutex> lock{ranges[thread].mutex};
+						try_range &own = ranges[thread];
+						if (own.begin < own.end) {
+							begin     = own.begin;
+							end       = own.end - own.begin < chunk ? own.end : own.begin + chunk;
+							own.begin = end;
+							return true;
+						}
+					}
+					if (!steal(thread)) {
+						return false;
+					}
+				}
+			}
+
+		private:
+			/// move the upper half of the tries of another thread to this one
+			bool steal(unsigned thread) {
+				for (unsigned i = 1; i < count; ++i) {
+					try_range &victim = ranges[(thread + i) % count];
+					uint64_t begin, end;
+					{
+						std::lock_guard<std::mutex> lock{victim.mutex};
+						if (victim.begin >= victim.end) {
+							continue;
+						}
+						begin      = victim.begin + (victim.end - victim.begin) / 2;
+						end        = victim.end;
+						victim.end = begin;
+					}
+					std::lock_guard<std::mutex> lock{ranges[thread].mutex};
+					ranges[thread].begin = begin;
+					ranges[thread].end   = end;
+					return true;
+				}
+				return false;
+			}
+		};
+
+		/// what a thread found in its tries; a thread counts in a local one and stores it once
+		/// when it is done, the results of the threads are next to each other in memory
+		struct thread_result {
+			uint64_t tries = 0;
+			try_record summary;
+		};
+
+		/// the result of a constexpr test at run time
+		struct parallel_result {
+			string_part name;
+			/// the number of tries that were run, and the number that was asked for
+			uint64_t tries, total;
+			/// the first failing try, counted from 1; 0 when the test passed
+			uint64_t failnum;
+			/// the round of the first failing try, which is try report.failnum - 1 of the round
+			uint64_t round;
+			double seconds;
+			unsigned threads;
+			try_record summary;
+			/// the failure as the compile time runner reports it, with the key and try of its
+			/// round; the parameters are in text, parameter i ends at ends[i]
+			test_report report;
+			std::string text;
+			std::vector<unsigned> ends;
+		};
+
+		template <typename Config, typename Prop, unsigned tries, typename... Gens>
+		parallel_result run_parallel(const parallel_config &config) {
+			using params       = cparams<Gens...>;
+			const uint64_t key = test_seed<ctest<Config, Prop, tries, Gens...>>::key;
+			const unsigned threads = config.threads == 0 ? 1 : config.threads;
+
+			try_scheduler scheduler{config.tries, threads};
+			// the first failing try found so far, tries after it do not need to run
+			std::atomic<uint64_t> failure{config.tries};
+			std::vector<thread_result> results(threads);
+
+			auto work = [&](unsigned thread) {
+				thread_result result;
+				uint64_t begin, end;
+				while (scheduler.next(thread, begin, end)) {
+					for (uint64_t t = begin; t < end && t < failure.load(); ++t) {
+						params p = generate_try<Config, params>(round_key(key, t / tries),
+						                                        unsigned(t % tries), tries);
+						result.summary = combine(result.summary, try_record_of(p.stats()));
+						++result.tries;
+						if (!p.template call<Prop>()) {
+							uint64_t first = failure.load();
+							while (t < first && !failure.compare_exchange_weak(first, t)) {
+							}
+							break;
+						}
+					}
+				}
+				results[thread] = result;
+			};
+
+			auto start = std::chrono::steady_clock::now();
+			std::vector<std::thread> pool;
+			for (unsigned i = 1; i < threads; ++i) {
+				pool.emplace_back(work, i);
+			}
+			work(0);
+			for (std::thread &thread : pool) {
+				thread.join();
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			parallel_result run{ctest_name<Prop>(), 0,  config.tries, 0, 0, elapsed.count(),
+			                    threads,            {}, {},           {}, {}};
+			for (const thread_result &result : results) {
+				run.tries += result.tries;
+				run.summary = combine(run.summary, result.summary);
+			}
+			if (failure.load() == config.tries) {
+				return run;
+			}
+
+			// shrink the first failure, the same way as while compiling
+			uint64_t t          = failure.load();
+			uint64_t round      = round_key(key, t / tries);
+			unsigned try_num    = unsigned(t % tries);
+			cresult<params> res = cshrink<Config, Prop>(cresult<params>{
+			        true, try_num + 1, round, 0, 0, false, run.summary,
+			        generate_try<Config, params>(round, try_num, tries)});
+			run.failnum = t + 1;
+			run.round   = t / tries;
+
+			run.ends.resize(sizeof...(Gens) + 1);
+			run.text.resize(params_length(res.params));
+			ctext_writer out{&run.text[0], 0};
+			res.params.print(out, run.ends.data());
+			run.report = {run.name,
+			              true,
+			              res.failnum,
+			              false,
+			              tries,
+			              res.shrinks,
+			              res.candidates,
+			              res.partial,
+			              res.summary,
+			              res.key,
+			              test_id<ctest<Config, Prop, tries, Gens...>>(),
+			              {"false", 0, 5},
+			              nullptr,
+			              sizeof...(Gens)};
+			return run;
+		}
+
+		inline std::ostream &print_parallel(std::ostream &stream, const std::string &suite,
+		                                    const parallel_result &run) {
+			auto ms = uint64_t(run.seconds * 1000);
+			stream << "[ RUN      ] " << suite << run.name << std::endl;
+			if (run.failnum != 0) {
+				const test_report &test = run.report;
+				stream << "Failure after " << run.failnum << "/" << run.total << " tries, at try "
+				       << test.failnum - 1 << " of round " << run.round << ", and " << test.shrinks << " shrinks (" << test.candidates << " candidates tried)."
+				       << (test.partial ? " Partially shrunk, a shrink limit of the test was hit."
+				                        : "")
+				       << std::endl;
+			}
+			print_tries(stream, run.summary);
+			stream << "Ran " << run.tries << " tries in " << ms << " ms on " << run.threads
+			       << (run.threads == 1 ? " thread" : " threads") << " ("
+			       << uint64_t(run.seconds > 0 ? run.tries / run.seconds : 0) << " tries/s)."
+			       << std::endl;
+			if (run.failnum == 0) {
+				stream << "[       OK ] " << suite << run.name << " (" << ms << " ms)" << std::endl;
+				return stream;
+			}
+			const test_report &test = run.report;
+			stream << "Result: " << test.result << std::endl << "Parameters:";
+			for (unsigned i = 0; i < test.num_params; ++i) {
+				stream << "\n\t" << run.text.substr(i == 0 ? 0 : run.ends[i - 1],
+				                                     run.ends[i] - (i == 0 ? 0 : run.ends[i - 1]));
+			}
+			stream << std::endl
+			       << "Reproduce: -DMETACHECK_REPRODUCE=" << suite << run.name
+			       << " -DMETACHECK_REPRODUCE_ID=" << test.test_id
+			       << " -DMETACHECK_REPRODUCE_SEED=" << test.test_key
+			       << " -DMETACHECK_REPRODUCE_TRY=" << test.failnum - 1 << std::endl;
+			stream << "[  FAILED  ] " << suite << run.name << " (" << ms << " ms)" << std::endl;
+			return stream;
+		}
+
+		/// the results of the constexpr tests of a section, run at run time
+		struct parallel_section {
+			std::string name;
+			std::vector<parallel_result> tests;
+			std::vector<parallel_section> sections;
+
+			unsigned num_tests() const {
+				unsigned tests_in_sections = 0;
+				for (const parallel_section &section : sections) {
+					tests_in_sections += section.num_tests();
+				}
+				return unsigned(tests.size()) + tests_in_sections;
+			}
+
+			unsigned num_failed() const {
+				unsigned failed = 0;
+				for (const parallel_result &test : tests) {
+					failed += test.failnum != 0;
+				}
+				for (const parallel_section &section : sections) {
+					failed += section.num_failed();
+				}
+				return failed;
+			}
+		};
+
+		template <uint64_t patterns>
+		struct parallel_items {
+			const parallel_config &config;
+			parallel_section &section;
+
+			template <typename Config, typename Prop, unsigned tries, typename... Gens>
+			void operator()(const ctest<Config, Prop, tries, Gens...>) {
+				if (cselected<Prop>(patterns) &&
+				    reproduced(test_id<ctest<Config, Prop, tries, Gens...>>())) {
+					section.tests.push_back(
+					        run_parallel<Config, Prop, tries, Gens...>(config));
+				}
+			}
+
+			// the tests over types only run while compiling
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename... Params>
+			void operator()(const test<Config, Func, tries, Params...>) {
+			}
+
+			template <typename... Tests>
+			void operator()(const detail::section<Tests...> nested) {
+				parallel_section result{nested.name, {}, {}};
+				parallel_items<unknown_section_patterns()> items{config, result};
+				foreach
+					<void>(nested.tests, [&](auto item) { items(item); });
+				section.sections.push_back(std::move(result));
+			}
+
+			// a precalculated section has no tests to run any more
+			void operator()(const section_base *) {
+			}
+		};
+
+		inline std::ostream &print_parallel(std::ostream &stream, const std::string &root,
+		                                    const parallel_section &section) {
+			std::string suite = root + section.name + ".";
+			stream << "[----------] " << section.num_tests() << " tests from " << section.name
+			       << std::endl;
+			for (const parallel_result &test : section.tests) {
+				print_parallel(stream, suite, test);
+			}
+			for (const parallel_section &nested : section.sections) {
+				print_parallel(stream, suite, nested);
+			}
+			stream << "[----------] " << section.num_tests() << " tests from " << section.name
+			       << " (0 ms total)" << std::endl;
+			return stream;
+		}
+
+		inline std::ostream &write_regressions(std::ostream &stream, const std::string &root,
+		                                       const parallel_section &section) {
+			std::string suite = root + section.name + ".";
+			for (const parallel_result &test : section.tests) {
+				if (test.failnum != 0) {
+					write_regression(stream, suite, test.report);
+				}
+			}
+			for (const parallel_section &nested : section.sections) {
+				write_regressions(stream, suite, nested);
+			}
+			return stream;
+		}
+
+		struct parallel_printer {
+			std::vector<parallel_section> sections;
+
+			operator int() const {
+				for (const parallel_section &section : sections) {
+					if (section.num_failed() != 0) {
+						return 1;
+					}
+				}
+				return 0;
+			}
+		};
+
+		inline std::ostream &operator<<(std::ostream &stream, const parallel_printer &printer) {
+			unsigned num_tests = 0, num_failed = 0;
+			for (const parallel_section &section : printer.sections) {
+				num_tests += section.num_tests();
+				num_failed += section.num_failed();
+			}
+			std::size_t num_suites = printer.sections.size();
+
+			stream << "[==========] Running " << num_tests << (num_tests == 1 ? " test" : " tests")
+			       << " from " << num_suites << " test " << (num_suites == 1 ? "case." : "cases.")
+			       << std::endl
+			       << "Seed: " << random_seed::key << std::endl;
+			for (const parallel_section &section : printer.sections) {
+				print_parallel(stream, "", section);
+			}
+			stream << std::endl
+			       << "[----------] Global test environment tear-down" << std::endl
+			       << "[==========] " << num_tests << (num_tests == 1 ? " test" : " tests")
+			       << " from " << num_suites << " test " << (num_suites == 1 ? "case" : "cases")
+			       << " ran. (0 ms total)" << std::endl
+			       << "[  PASSED  ] " << num_tests - num_failed << " tests." << std::endl;
+			return stream;
+		}
+	} // namespace detail
+
+	/// add the failures of the result of test_parallel to the regression header, so the compiled
+	/// tests replay them; call it once per run, printing the result writes nothing
+	inline void record_results(const detail::parallel_printer &printer) {
+#ifdef METACHECK_REGRESSIONS
+		std::ostringstream failures;
+		for (const detail::parallel_section &section : printer.sections) {
+			detail::write_regressions(failures, "", section);
+		}
+		detail::append_regressions(METACHECK_REGRESSIONS, failures.str());
+#else
+		static_cast<void>(printer);
+#endif
+	}
+
+	/// run the constexpr tests of the sections at run time, with the tries and threads of the
+	/// config; the result prints like the result of test_all
+	template <typename... Sections>
+	detail::parallel_printer test_parallel(const parallel_config &config,
+	                                       const Sections... sections) {
+		detail::parallel_printer printer;
+		foreach
+			<void>(std::make_tuple(sections...), [&](auto section) {
+				detail::parallel_section result{section.name, {}, {}};
+				detail::parallel_items<detail::unknown_section_patterns()> items{config, result};
+				foreach
+					<void>(section.tests, [&](auto item) { items(item); });
+				printer.sections.push_back(std::move(result));
+			});
+		return printer;
+	}
+} // namespace mc
@@ -0,0 +1,31 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the headers to precompile for the test translation units of a target: kvasir mpl and the part of
+// metacheck that only depends on the definitions of the target as a whole, like the seed and the
+// test filter. shard.hpp, regressions.hpp and metacheck.hpp itself are left out, since they depend
+// on definitions of a single translation unit (its shard and its key in the result cache) or on
+// the regression header, which the test runner rewrites
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <kvasir/mpl/mpl.hpp>
+
+#include "config.hpp"
+#include "core.hpp"
+#include "ctest.hpp"
+#include "filter.hpp"
+#include "generators.hpp"
+#include "random.hpp"
+#include "report.hpp"
+#include "reproduce.hpp"
+#include "type_name.hpp"
+#include "utility.hpp"
@@ -4,43 +4,97 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 #pragma once
 
+#include <cstdint>
+
 #include <kvasir/mpl/mpl.hpp>
 
+// METACHECK_SEED_HEADER can name a generated header that defines METACHECK_RANDOM, so the seed can
+// change without changing the compiler flags
+#ifdef METACHECK_SEED_HEADER
+#include METACHECK_SEED_HEADER
+#endif
+
 namespace mc {
-	template <uint64_t cur_state>
+	namespace detail {
+		/// the weyl sequence increment of SplitMix64, the golden ratio as a 64 bit fraction
+		constexpr uint64_t golden_gamma = 0x9E3779B97F4A7C15;
+
+		/// the SplitMix64 output function; bijective, and every input bit affects every output
+		/// bit
+		constexpr uint64_t mix64(uint64_t z) {
+			z = (z ^ (z >> 30)) * uint64_t(0xBF58476D1CE4E5B9);
+			z = (z ^ (z >> 27)) * uint64_t(0x94D049BB133111EB);
+			return z ^ (z >> 31);
+		}
+	} // namespace detail
+
+	/// the size at which generators use their full range
+	constexpr unsigned nominal_size = 100;
+
+	/// scale n, the full range of a value, down to size
+	constexpr uint64_t scale_to_size(uint64_t n, unsigned size) {
+		return size < nominal_size ? n * size / nominal_size : n;
+	}
+
+	/// the limit on the values generated from a seed: the number of nodes (single values and
+	/// lists) and how deep lists may be nested
+	template <unsigned max_nodes, unsigned max_depth>
+	struct budget {
+		constexpr static unsigned nodes = max_nodes;
+		constexpr static unsigned depth = max_depth;
+	};
+	using unlimited_budget = budget<unsigned(-1), unsigned(-1)>;
+
+	/// a position in a stream of random numbers
+	/// this is a counter based generator (SplitMix64): every number in the stream is a constexpr
+	/// function of the key and its position, so any number can be read without instantiating the
+	/// seeds before it
+	/// the seed also carries the size that the generated values should have, from 0 for the
+	/// smallest values up to nominal_size for the full range of a generator, and the budget that
+	/// the generated values have to stay within
+	template <uint64_t cur_key, uint64_t cur_counter = 0, unsigned cur_size = nominal_size,
+	          typename Budget = unlimited_budget>
 	struct seed_state {
-		constexpr static uint64_t state = cur_state;
+		constexpr static uint64_t key     = cur_key;
+		constexpr static uint64_t counter = cur_counter;
+		constexpr static unsigned size    = cur_size;
+		using budget                      = Budget;
+
+		/// the random number n positions further in the stream
+		constexpr static uint64_t at(uint64_t n) {
+			return detail::mix64(key + (counter + n + 1) * detail::golden_gamma);
+		}
+
+		/// the seed n positions further in the stream
+		template <uint64_t n>
+		using jump = seed_state<key, counter + n, size, budget>;
+
+		/// the seed after this one has been used
+		using next = jump<1>;
 
-		/// get the next seed from the prng based on the seed that was previously generated
-		/// this implementation is the "xorshift*" number generator, chosen for its word size and
-		/// good hashing of values
-		/// to be noted is that this version is made to be compatible with c++11 constexpr, which
-		/// is why it looks so convoluted
-		using next = seed_state<(state ^ (state >> 12)) ^ ((state ^ (state >> 12)) << 25) ^
-		                        ((state ^ (state >> 12)) ^ ((state ^ (state >> 12)) << 25) >> 27)>;
+		/// an independent stream for the n-th child of this seed, so that many values can be
+		/// generated from one seed without any of them depending on another; the keys of the
+		/// children are themselves the stream that is keyed by the first number of this seed;
+		/// the child can be given its own share of the budget
+		template <uint64_t n, typename NewBudget = budget>
+		using split = seed_state<detail::mix64(at(0) + (n + 1) * detail::golden_gamma), 0, size,
+		                         NewBudget>;
+
+		/// the same position in the stream with a different size
+		template <unsigned new_size>
+		using with_size = seed_state<key, counter, new_size, budget>;
 
 		constexpr operator uint64_t() const {
-			return state * uint64_t(0x2545F4914F6CDD1D);
+			return at(0);
 		}
 	};
 
-#ifdef METACHECK_RANDOM
-	using random_seed = seed_state<uint64_t(METACHECK_RANDOM)>;
-#else
-	// initialize the seed with the hashed time for randomness sake
-	using random_seed =
-	        seed_state<seed_state<(((((__TIME__[1] - '0') + (__TIME__[0] - '0') * 10) * 60) +
-	                                ((__TIME__[4] - '0') + (__TIME__[3] - '0') * 10)) *
-	                               60) +
-	                              ((__TIME__[7] - '0') + (__TIME__[6] - '0') * 10)>{}>;
-#endif
-
 	namespace detail {
 		template <typename Seed, uint64_t i>
 		using encode_int
-		        // xor the int with the output of the current seed state, then get the next hash to
-		        // distribute the random bits
-		        = typename seed_state<Seed{} ^ i>::next;
+		        // xor the int with the output of the current seed state, then use the mixed result
+		        // as the key of a new stream
+		        = seed_state<mix64(Seed{} ^ i)>;
 
 		constexpr uint64_t encode_string(uint64_t seed, const char *s, unsigned pos) {
 			return s[pos] == '\0' ? seed
@@ -51,9 +105,36 @@ namespace mc {
 			                                              s[pos],
 			                                      s, pos + 1);
 		}
+
+		/// FNV-1a hash of a string of any length, mixed with a seed
+		constexpr uint64_t hash_string(uint64_t seed, const char *s) {
+			uint64_t hash = 0xCBF29CE484222325 ^ seed;
+			for (unsigned pos = 0; s[pos] != '\0'; ++pos) {
+				hash = (hash ^ uint64_t(static_cast<unsigned char>(s[pos]))) * 0x100000001B3;
+			}
+			return mix64(hash);
+		}
+
+		/// a hash of the full name of T, which does not change as long as T is the same type
+		template <typename T>
+		constexpr uint64_t type_hash(uint64_t seed) {
+#ifdef _MSC_VER
+			return hash_string(seed, __FUNCSIG__);
+#else
+			return hash_string(seed, __PRETTY_FUNCTION__);
+#endif
+		}
 	} // namespace detail
 
-#define FILE_RANDOM         \
-	mc::detail::encode_int< \
-	        mc::seed_state<mc::detail::encode_string(mc::random_seed{}, __FILE__, 0)>, __LINE__>
+#if defined(METACHECK_RANDOM)
+	using random_seed = seed_state<uint64_t(METACHECK_RANDOM)>;
+#elif defined(METACHECK_RANDOM_TIME)
+	// a new seed every second, which makes every build a full rebuild
+	using random_seed =
+	        seed_state<detail::encode_string(detail::encode_string(0, __DATE__, 0), __TIME__, 0)>;
+#else
+	// a new seed every day; the sources stay the same for the rest of the day, so builds can be
+	// incremental and cached
+	using random_seed = seed_state<detail::encode_string(0, __DATE__, 0)>;
+#endif
 } // namespace mc
@@ -0,0 +1,171 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// a corpus of earlier failures that is replayed before the random tries of a test
+//
+// METACHECK_REGRESSIONS holds the path of a header with one line per failure:
+//
+//   METACHECK_REGRESSION("section.test", <id>, <seed>, <try>)
+//
+// every test first replays the tries of the regressions with its section, its name and its
+// test_id, and only when they all pass it goes on with its random tries; mc::record_results
+// appends the failures of a run to the header, so they are checked again by every later build
+#pragma once
+
+#include <cstdint>
+
+#include "filter.hpp"
+
+namespace mc {
+	namespace detail {
+		/// a failing try of a test, as it was printed in the reproduce line of the failure
+		struct regression {
+			const char *test;
+			uint64_t id;
+			uint64_t seed;
+			unsigned try_num;
+		};
+
+		constexpr regression regressions[] = {
+#ifdef METACHECK_REGRESSIONS
+#define METACHECK_REGRESSION(TEST, ID, SEED, TRY) {TEST, ID, SEED, TRY},
+#include METACHECK_REGRESSIONS
+#undef METACHECK_REGRESSION
+#endif
+		        // keeps the array from being empty
+		        {nullptr, 0, 0, 0}};
+
+		/// the key of a section without regressions of any test; no name has it as its key
+		constexpr uint64_t no_section = 0;
+
+		/// the hash of the full name of a section, continued from the hash of the part before it
+		constexpr uint64_t name_hash(string_part name, uint64_t hash = 0xCBF29CE484222325) {
+			for (unsigned pos = name.begin; pos < name.end; ++pos) {
+				hash = (hash ^ uint64_t(static_cast<unsigned char>(name.str[pos]))) * 0x100000001B3;
+			}
+			return hash;
+		}
+
+		/// the key of a section from the hash of its full name, to match the regressions of its
+		/// tests with
+		constexpr uint64_t section_key(uint64_t hash) {
+			// keep the key of a name apart from no_section
+			return hash | 1;
+		}
+
+		constexpr bool string_equal(string_part a, string_part b) {
+			if (a.end - a.begin != b.end - b.begin) {
+				return false;
+			}
+			for (unsigned i = 0; i < a.end - a.begin; ++i) {
+				if (a.str[a.begin + i] != b.str[b.begin + i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// the position of the name of the test in the full name of a regression
+		constexpr unsigned regression_name_begin(const regression &r) {
+			unsigned dot = string_length(r.test);
+			while (dot > 0 && r.test[dot - 1] != '.') {
+				--dot;
+			}
+			return dot;
+		}
+
+		/// the key of the section that recorded a regression; the tests that test_all is given
+		/// directly are in the section without a name
+		constexpr uint64_t regression_section_key(const regression &r) {
+			unsigned dot = regression_name_begin(r);
+			return section_key(name_hash({r.test, 0, dot > 0 ? dot - 1 : 0}));
+		}
+
+		/// whether r is a regression of the test with the given name and test_id, in any section;
+		/// the names are compared as they are, without wildcards
+		constexpr bool regression_of(const regression &r, string_part name, uint64_t id) {
+			return r.test != nullptr && r.id == id &&
+			       string_equal({r.test, regression_name_begin(r), string_length(r.test)}, name);
+		}
+
+		/// whether r is a regression of the test in the section with the given key
+		constexpr bool regression_of(const regression &r, string_part name, uint64_t id,
+		                             uint64_t section) {
+			return regression_of(r, name, id) && regression_section_key(r) == section;
+		}
+
+		/// whether the index-th regression is the first of the test in its section
+		constexpr bool first_in_section(string_part name, uint64_t id, unsigned index) {
+			if (!regression_of(regressions[index], name, id)) {
+				return false;
+			}
+			for (unsigned i = 0; i < index; ++i) {
+				if (regression_of(regressions[i], name, id,
+				                  regression_section_key(regressions[index]))) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// the number of sections that recorded regressions of a test
+		constexpr unsigned regression_section_count(string_part name, uint64_t id) {
+			unsigned count = 0;
+			for (unsigned i = 0; i < sizeof(regressions) / sizeof(regression); ++i) {
+				count += first_in_section(name, id, i);
+			}
+			return count;
+		}
+
+		/// the key of the index-th section that recorded regressions of a test, index has to be
+		/// less than its regression section count
+		constexpr uint64_t regression_section_at(string_part name, uint64_t id, unsigned index) {
+			unsigned i = 0;
+			while (!first_in_section(name, id, i) || index-- != 0) {
+				++i;
+			}
+			return regression_section_key(regressions[i]);
+		}
+
+		/// the number of regressions of a test
+		constexpr unsigned regression_count(string_part name, uint64_t id, uint64_t section) {
+			unsigned count = 0;
+			for (const regression &r : regressions) {
+				count += regression_of(r, name, id, section);
+			}
+			return count;
+		}
+
+		/// the index-th regression of a test, index has to be less than its regression count
+		constexpr regression regression_at(string_part name, uint64_t id, uint64_t section,
+		                                   unsigned index) {
+			unsigned i = 0;
+			while (!regression_of(regressions[i], name, id, section) || index-- != 0) {
+				++i;
+			}
+			return regressions[i];
+		}
+
+		template <template <typename...> class F>
+		constexpr unsigned regression_count(uint64_t id, uint64_t section) {
+			return regression_count(test_name<F>(), id, section);
+		}
+
+		template <template <typename...> class F>
+		constexpr regression regression_at(uint64_t id, uint64_t section, unsigned index) {
+			return regression_at(test_name<F>(), id, section, index);
+		}
+
+		template <template <typename...> class F>
+		constexpr unsigned regression_section_count(uint64_t id) {
+			return regression_section_count(test_name<F>(), id);
+		}
+
+		template <template <typename...> class F>
+		constexpr uint64_t regression_section_at(uint64_t id, unsigned index) {
+			return regression_section_at(test_name<F>(), id, index);
+		}
+	} // namespace detail
+} // namespace mc
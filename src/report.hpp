@@ -0,0 +1,246 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the results of the tests as plain data, and the sections that hold them; a test translation unit
+// only builds these as constants, everything that prints them is defined in runner.hpp, which only
+// the translation unit of the test runner includes
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+
+#include "filter.hpp"
+#include "utility.hpp"
+
+namespace mc {
+	namespace detail {
+		/// how large the parameters of a number of tries were, and how often the budget cut them
+		/// short; the empty record has no tries
+		struct try_record {
+			unsigned tries = 0, hits = 0;
+			unsigned min_nodes = std::numeric_limits<unsigned>::max(), total_nodes = 0,
+			         max_nodes = 0;
+			unsigned min_depth = std::numeric_limits<unsigned>::max(), total_depth = 0,
+			         max_depth = 0;
+			unsigned lists = 0, min_length = std::numeric_limits<unsigned>::max(),
+			         total_length = 0, max_length = 0;
+		};
+
+		/// the record of the tries of both records
+		constexpr try_record combine(const try_record &a, const try_record &b) {
+			return {a.tries + b.tries,
+			        a.hits + b.hits,
+			        min_of({a.min_nodes, b.min_nodes}),
+			        a.total_nodes + b.total_nodes,
+			        max_of({a.max_nodes, b.max_nodes}),
+			        min_of({a.min_depth, b.min_depth}),
+			        a.total_depth + b.total_depth,
+			        max_of({a.max_depth, b.max_depth}),
+			        a.lists + b.lists,
+			        min_of({a.min_length, b.min_length}),
+			        a.total_length + b.total_length,
+			        max_of({a.max_length, b.max_length})};
+		}
+
+		/// the result of a test, as far as the shards of a test need it to be merged
+		struct test_record {
+			bool failed;
+			try_record tries;
+		};
+
+		/// everything the runner prints of a single test
+		struct test_report {
+			string_part name;
+			bool failed;
+			/// the failing try, counted from 1; 0 when the test passed
+			unsigned failnum;
+			/// true when the failing try was a replayed regression, failnum is then its try
+			bool replayed;
+			unsigned tries, shrinks, candidates;
+			/// true when shrinking stopped at one of the limits of the test
+			bool partial;
+			try_record summary;
+			/// the seed of the failing try, to reproduce it with
+			uint64_t test_key;
+			/// the test_id of the test, 0 when the test passed
+			uint64_t test_id;
+			/// the type the function returned for the counterexample
+			string_part result;
+			/// the parameters of the counterexample
+			const string_part *params;
+			unsigned num_params;
+		};
+
+		class section_base;
+
+		/// a single item of a section: a test, a nested section, or neither when the test was
+		/// left out by the test filter
+		struct section_item {
+			const test_report *test;
+			const section_base *section;
+		};
+
+		// virtual base class so that you can use multiple translation units; the virtual members
+		// of it and of the sections below are only declared here and defined inline in runner.hpp,
+		// so a program that builds sections must include runner.hpp in one translation unit, or the
+		// vtables of the sections have nothing to point at
+		class section_base {
+		public:
+			const char *name;
+			/// the key of the section in the result cache, nullptr when it is not cached
+			const char *key;
+
+			constexpr section_base(const char *name, const char *key = nullptr)
+			    : name{name}, key{key} {};
+
+			virtual unsigned num_tests() const                                         = 0;
+			virtual unsigned num_failed() const                                        = 0;
+			virtual unsigned num_passed() const                                        = 0;
+			virtual std::ostream &print(std::ostream &stream, const char *test_root) const = 0;
+			virtual std::ostream &write_regressions(std::ostream &stream,
+			                                        const char *test_root) const = 0;
+
+			/// the record of the index-th result of the section
+			virtual test_record result_record(unsigned index) const = 0;
+			/// print the index-th result of the section with the tries of all its shards
+			virtual std::ostream &print_result_with(std::ostream &stream, const char *test_root,
+			                                        unsigned index,
+			                                        const try_record &tries) const = 0;
+
+			/// write the result of the section to the result cache, as the initializer of the
+			/// cached_section that replaces it in the next build
+			virtual void store(const char *cache_dir) const;
+		};
+
+		/// the results of the items of a section
+		class section_result : public section_base {
+		public:
+			const section_item *items;
+			unsigned count;
+
+			constexpr section_result(const char *name, const section_item *items,
+			                         unsigned count, const char *key = nullptr)
+			    : section_base{name, key}, items{items}, count{count} {
+			}
+
+			unsigned num_tests() const override;
+			unsigned num_passed() const override;
+			unsigned num_failed() const override;
+			std::ostream &print(std::ostream &stream, const char *test_root) const override;
+			std::ostream &write_regressions(std::ostream &stream,
+			                                const char *test_root) const override;
+			test_record result_record(unsigned index) const override;
+			std::ostream &print_result_with(std::ostream &stream, const char *test_root,
+			                                unsigned index,
+			                                const try_record &tries) const override;
+		};
+
+		/// the result of a section that was taken from the result cache instead of being tested
+		class cached_section : public section_base {
+		public:
+			const unsigned tests, passed, failed;
+			/// the report of the section, as it was printed when it was tested
+			const char *report;
+
+			constexpr cached_section(const char *name, unsigned tests, unsigned passed,
+			                         unsigned failed, const char *report)
+			    : section_base{name}, tests{tests}, passed{passed}, failed{failed},
+			      report{report} {
+			}
+
+			unsigned num_tests() const override;
+			unsigned num_passed() const override;
+			unsigned num_failed() const override;
+			std::ostream &print(std::ostream &stream, const char *test_root) const override;
+			std::ostream &write_regressions(std::ostream &stream,
+			                                const char *test_root) const override;
+			test_record result_record(unsigned index) const override;
+			std::ostream &print_result_with(std::ostream &stream, const char *test_root,
+			                                unsigned index,
+			                                const try_record &tries) const override;
+		};
+
+		/// a section that was tested in shards, each in its own translation unit and with its
+		/// own part of the tries of every test; the results of the shards are merged per test
+		class sharded_section : public section_base {
+		public:
+			/// the section_base pointers exported by the shards, in order
+			const section_base *const *const *shards;
+			unsigned count;
+
+			constexpr sharded_section(const section_base *const *const *shards, unsigned count)
+			    : section_base{nullptr}, shards{shards}, count{count} {
+			}
+
+			const section_base &shard(unsigned index) const;
+			/// the shard to print a result from; the first one that failed, which has the first
+			/// failing try, or the first one when none of them failed
+			const section_base &printed_shard(unsigned index) const;
+
+			unsigned num_tests() const override;
+			unsigned num_passed() const override;
+			unsigned num_failed() const override;
+			std::ostream &print(std::ostream &stream, const char *test_root) const override;
+			std::ostream &write_regressions(std::ostream &stream,
+			                                const char *test_root) const override;
+			test_record result_record(unsigned index) const override;
+			std::ostream &print_result_with(std::ostream &stream, const char *test_root,
+			                                unsigned index,
+			                                const try_record &tries) const override;
+		};
+
+		// the registered sections live in a dedicated linker section, of which the linker provides
+		// the bounds; every entry is a constant, so registering costs nothing at run time and does
+		// not depend on the order of static initialization
+#if defined(_MSC_VER)
+#pragma section("mc_sec$a", read)
+#pragma section("mc_sec$m", read)
+#pragma section("mc_sec$z", read)
+#define METACHECK_REGISTRY_ENTRY __declspec(allocate("mc_sec$m"))
+		__declspec(allocate("mc_sec$a")) const section_base *const registry_begin[] = {nullptr};
+		__declspec(allocate("mc_sec$z")) const section_base *const registry_end[]   = {nullptr};
+#elif defined(__APPLE__)
+#define METACHECK_REGISTRY_ENTRY __attribute__((used, section("__DATA,__mc_sections")))
+		extern const section_base *const registry_begin[] __asm(
+		        "section$start$__DATA$__mc_sections");
+		extern const section_base *const registry_end[] __asm(
+		        "section$end$__DATA$__mc_sections");
+#else
+#define METACHECK_REGISTRY_ENTRY __attribute__((used, section("metacheck_sections")))
+		// weak, so they are null when no section was registered
+		extern "C" const section_base *const __start_metacheck_sections[] __attribute__((weak));
+		extern "C" const section_base *const __stop_metacheck_sections[] __attribute__((weak));
+		const section_base *const *const registry_begin = __start_metacheck_sections;
+		const section_base *const *const registry_end   = __stop_metacheck_sections;
+#endif
+
+		/// all the sections that were registered with METACHECK_REGISTER, from any translation
+		/// unit, as the results of a single section without a name of its own
+		class registry : public section_base {
+		public:
+			constexpr registry() : section_base{nullptr} {
+			}
+
+			unsigned num_tests() const override;
+			unsigned num_passed() const override;
+			unsigned num_failed() const override;
+			std::ostream &print(std::ostream &stream, const char *test_root) const override;
+			std::ostream &write_regressions(std::ostream &stream,
+			                                const char *test_root) const override;
+			void store(const char *cache_dir) const override;
+			test_record result_record(unsigned index) const override;
+			std::ostream &print_result_with(std::ostream &stream, const char *test_root,
+			                                unsigned index,
+			                                const try_record &tries) const override;
+		};
+
+		constexpr registry registered_sections{};
+	} // namespace detail
+
+	/// the sections registered with METACHECK_REGISTER in any translation unit, to be passed to
+	/// test_all instead of a pointer per translation unit
+	constexpr const detail::section_base *registered_sections = &detail::registered_sections;
+} // namespace mc
@@ -0,0 +1,59 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// reproduce a single failure; every failing test prints the definitions that reproduce it:
+//
+//   -DMETACHECK_REPRODUCE=section.test -DMETACHECK_REPRODUCE_ID=<id>
+//   -DMETACHECK_REPRODUCE_SEED=<seed> -DMETACHECK_REPRODUCE_TRY=<try>
+//
+// only that test is compiled, as if METACHECK_REPRODUCE was the test filter, and only the failing
+// try of it is generated before its counterexample is shrunk. a section can test the same
+// function more than once, with another config or other generators, so the id (the test_id of the
+// test) tells which of them failed; without it every test with the name is reproduced
+#pragma once
+
+#include <cstdint>
+
+#include "random.hpp"
+
+// the numbers are given without a suffix, and are pasted to one since seeds and ids do not fit in
+// a signed 64 bit integer
+#define METACHECK_ULL_IMPL(N) N##ull
+#define METACHECK_ULL(N) METACHECK_ULL_IMPL(N)
+
+#ifdef METACHECK_REPRODUCE
+#if !defined(METACHECK_REPRODUCE_SEED) || !defined(METACHECK_REPRODUCE_TRY)
+#error "METACHECK_REPRODUCE needs METACHECK_REPRODUCE_SEED and METACHECK_REPRODUCE_TRY as well"
+#endif
+
+// the name of the test is given without quotes, so it can be passed to cmake and to the compiler
+// in the same way
+#define METACHECK_STRINGIFY_IMPL(...) #__VA_ARGS__
+#define METACHECK_STRINGIFY(...) METACHECK_STRINGIFY_IMPL(__VA_ARGS__)
+
+namespace mc {
+	namespace detail {
+		/// the seed of the reproduced test, as printed by the failure
+		using reproduce_seed = seed_state<METACHECK_ULL(METACHECK_REPRODUCE_SEED)>;
+		/// the index of the failing try
+		constexpr unsigned reproduce_try = METACHECK_REPRODUCE_TRY;
+	} // namespace detail
+} // namespace mc
+#endif
+
+namespace mc {
+	namespace detail {
+		/// whether the test with the given test_id is compiled; when a failure is reproduced
+		/// with its id, only the test with that id is
+		constexpr bool reproduced(uint64_t id) {
+#if defined(METACHECK_REPRODUCE) && defined(METACHECK_REPRODUCE_ID)
+			return id == METACHECK_ULL(METACHECK_REPRODUCE_ID);
+#else
+			static_cast<void>(id);
+			return true;
+#endif
+		}
+	} // namespace detail
+} // namespace mc
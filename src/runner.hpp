@@ -0,0 +1,545 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the test runner: prints the results of the tests like google test does; mc::record_results
+// adds the failures to the regression header and stores the results in the result cache
+//
+// include it in the translation unit that runs the tests; it defines the members of the sections
+// of report.hpp. the test translation units only include metacheck.hpp, so they do not pay for
+// parsing the reporting
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "metacheck.hpp"
+
+namespace mc {
+	namespace detail {
+		inline std::ostream &operator<<(std::ostream &stream, const string_part &part) {
+			return stream.write(part.str + part.begin, part.end - part.begin);
+		}
+
+		template <typename Ostream>
+		void print_range(Ostream &stream, const char *name, unsigned min, uint64_t total,
+		                 unsigned count, unsigned max) {
+			stream << name;
+			if (count == 0) {
+				stream << " -";
+				return;
+			}
+			// the mean rounded to a single decimal
+			uint64_t tenths = (total * 10 + count / 2) / count;
+			stream << " " << min << "/" << tenths / 10 << "." << tenths % 10 << "/" << max;
+		}
+
+		template <typename Ostream>
+		void print_tries(Ostream &stream, const try_record &r) {
+			stream << "Generated in " << r.tries << " tries (min/mean/max):";
+			print_range(stream, " nodes", r.min_nodes, r.total_nodes, r.tries, r.max_nodes);
+			print_range(stream, ", depth", r.min_depth, r.total_depth, r.tries, r.max_depth);
+			print_range(stream, ", list length", r.min_length, r.total_length, r.lists,
+			            r.max_length);
+			stream << std::endl;
+			if (r.hits != 0) {
+				stream << "The generation budget was hit " << r.hits
+				       << (r.hits == 1 ? " time." : " times.") << std::endl;
+			}
+		}
+
+		/// print the result of a test with the given tries, those of all the shards of the test
+		inline std::ostream &print_test(std::ostream &stream, const std::string &suite,
+		                                const test_report &test, const try_record &summary) {
+			stream << "[ RUN      ] " << suite << test.name << std::endl;
+			if (!test.failed) {
+				print_tries(stream, summary);
+				stream << "[       OK ] " << suite << test.name << " (0 ms)" << std::endl;
+				return stream;
+			}
+			if (test.replayed) {
+				stream << "Regression replay failed (seed " << test.test_key << ", try "
+				       << test.failnum - 1 << "), " << test.shrinks << " shrinks ("
+				       << test.candidates << " candidates tried).";
+			} else {
+				stream << "Failure after " << test.failnum << "/" << test.tries << " tries and "
+				       << test.shrinks << " shrinks (" << test.candidates << " candidates tried).";
+			}
+			stream << (test.partial ? " Partially shrunk, a shrink limit of the test was hit." : "")
+			       << std::endl;
+			print_tries(stream, summary);
+			stream << "Result: " << test.result << std::endl << "Parameters:";
+			for (unsigned i = 0; i < test.num_params; ++i) {
+				stream << "\n\t" << test.params[i];
+			}
+			stream << std::endl
+			       << "Reproduce: -DMETACHECK_REPRODUCE=" << suite << test.name
+			       << " -DMETACHECK_REPRODUCE_ID=" << test.test_id
+			       << " -DMETACHECK_REPRODUCE_SEED=" << test.test_key
+			       << " -DMETACHECK_REPRODUCE_TRY=" << test.failnum - 1 << std::endl;
+			stream << "[  FAILED  ] " << suite << test.name << " (0 ms)" << std::endl;
+			return stream;
+		}
+
+		/// write the line of a failure of the test for the regression header
+		inline std::ostream &write_regression(std::ostream &stream, const std::string &suite,
+		                                      const test_report &test) {
+			if (test.failed) {
+				stream << "METACHECK_REGRESSION(\"" << suite << test.name << "\", " << test.test_id
+				       << "ull, " << test.test_key << "ull, " << test.failnum - 1 << ")"
+				       << std::endl;
+			}
+			return stream;
+		}
+
+		inline bool is_skipped(const section_item &item) {
+			return item.test == nullptr && item.section == nullptr;
+		}
+
+		/// the record of an item; a nested section only records whether it failed
+		inline test_record item_record(const section_item &item) {
+			if (item.test != nullptr) {
+				return {item.test->failed, item.test->summary};
+			}
+			return {item.section->num_failed() != 0, {}};
+		}
+
+		inline std::ostream &print_item(std::ostream &stream, const std::string &root,
+		                                const section_item &item, const try_record &tries) {
+			if (item.test != nullptr) {
+				return print_test(stream, root, *item.test, tries);
+			}
+			return item.section->print(stream, root.c_str());
+		}
+
+		inline std::ostream &write_item_regressions(std::ostream &stream, const std::string &root,
+		                                            const section_item &item) {
+			if (item.test != nullptr) {
+				return write_regression(stream, root, *item.test);
+			}
+			return item.section->write_regressions(stream, root.c_str());
+		}
+
+		inline void section_base::store(const char *cache_dir) const {
+			if (key == nullptr) {
+				return;
+			}
+			std::ofstream file{std::string(cache_dir) + "/" + key + ".hpp"};
+			file << "\"" << name << "\", " << num_tests() << ", " << num_passed() << ", "
+			     << num_failed() << ", R\"metacheck(";
+			print(file, "") << ")metacheck\"" << std::endl;
+		}
+
+		inline unsigned section_result::num_tests() const {
+			unsigned tests = 0;
+			for (unsigned i = 0; i < count; ++i) {
+				tests += !is_skipped(items[i]);
+			}
+			return tests;
+		}
+
+		inline unsigned section_result::num_passed() const {
+			unsigned passed = 0;
+			for (unsigned i = 0; i < count; ++i) {
+				if (items[i].test != nullptr) {
+					passed += !items[i].test->failed;
+				} else if (items[i].section != nullptr) {
+					passed += items[i].section->num_passed();
+				}
+			}
+			return passed;
+		}
+
+		inline unsigned section_result::num_failed() const {
+			unsigned failed = 0;
+			for (unsigned i = 0; i < count; ++i) {
+				if (items[i].test != nullptr) {
+					failed += items[i].test->failed;
+				} else if (items[i].section != nullptr) {
+					failed += items[i].section->num_failed();
+				}
+			}
+			return failed;
+		}
+
+		inline std::ostream &section_result::print(std::ostream &stream,
+		                                           const char *test_root) const {
+			std::string new_root{test_root};
+			new_root.append(name).append(".");
+			stream << "[----------] " << num_tests() << " tests from " << name << std::endl;
+			for (unsigned i = 0; i < count; ++i) {
+				if (!is_skipped(items[i])) {
+					print_item(stream, new_root, items[i], item_record(items[i]).tries);
+				}
+			}
+			stream << "[----------] " << num_tests() << " tests from " << name
+			       << " (0 ms total)" << std::endl;
+			return stream;
+		}
+
+		inline std::ostream &section_result::write_regressions(std::ostream &stream,
+		                                                       const char *test_root) const {
+			std::string new_root{test_root};
+			new_root.append(name).append(".");
+			for (unsigned i = 0; i < count; ++i) {
+				if (!is_skipped(items[i])) {
+					write_item_regressions(stream, new_root, items[i]);
+				}
+			}
+			return stream;
+		}
+
+		/// the index-th item that was not skipped
+		inline const section_item *result_item(const section_result &section, unsigned index) {
+			for (unsigned i = 0; i < section.count; ++i) {
+				if (!is_skipped(section.items[i]) && index-- == 0) {
+					return &section.items[i];
+				}
+			}
+			return nullptr;
+		}
+
+		inline test_record section_result::result_record(unsigned index) const {
+			const section_item *item = result_item(*this, index);
+			return item != nullptr ? item_record(*item) : test_record{false, {}};
+		}
+
+		inline std::ostream &section_result::print_result_with(std::ostream &stream,
+		                                                       const char *test_root,
+		                                                       unsigned index,
+		                                                       const try_record &tries) const {
+			std::string new_root{test_root};
+			new_root.append(name).append(".");
+			const section_item *item = result_item(*this, index);
+			return item != nullptr ? print_item(stream, new_root, *item, tries) : stream;
+		}
+
+		inline unsigned cached_section::num_tests() const {
+			return tests;
+		}
+		inline unsigned cached_section::num_passed() const {
+			return passed;
+		}
+		inline unsigned cached_section::num_failed() const {
+			return failed;
+		}
+
+		inline std::ostream &cached_section::print(std::ostream &stream, const char *) const {
+			return stream << report;
+		}
+
+		// the failures were added to the regressions when they were found
+		inline std::ostream &cached_section::write_regressions(std::ostream &stream,
+		                                                       const char *) const {
+			return stream;
+		}
+
+		// only the report of the section as a whole is cached, so it is printed in place of its
+		// first result
+		inline test_record cached_section::result_record(unsigned index) const {
+			return {index == 0 && failed != 0, {}};
+		}
+
+		inline std::ostream &cached_section::print_result_with(std::ostream &stream, const char *,
+		                                                       unsigned index,
+		                                                       const try_record &) const {
+			return index == 0 ? stream << report : stream;
+		}
+
+		inline const section_base &sharded_section::shard(unsigned index) const {
+			return **shards[index];
+		}
+
+		inline const section_base &sharded_section::printed_shard(unsigned index) const {
+			for (unsigned i = 0; i < count; ++i) {
+				if (shard(i).result_record(index).failed) {
+					return shard(i);
+				}
+			}
+			return shard(0);
+		}
+
+		inline test_record sharded_section::result_record(unsigned index) const {
+			test_record record{false, {}};
+			for (unsigned i = 0; i < count; ++i) {
+				test_record part = shard(i).result_record(index);
+				record.failed    = record.failed || part.failed;
+				record.tries     = combine(record.tries, part.tries);
+			}
+			return record;
+		}
+
+		inline std::ostream &sharded_section::print_result_with(std::ostream &stream,
+		                                                        const char *test_root,
+		                                                        unsigned index,
+		                                                        const try_record &tries) const {
+			return printed_shard(index).print_result_with(stream, test_root, index, tries);
+		}
+
+		inline unsigned sharded_section::num_tests() const {
+			return shard(0).num_tests();
+		}
+		inline unsigned sharded_section::num_failed() const {
+			unsigned failed = 0;
+			for (unsigned i = 0; i < num_tests(); ++i) {
+				failed += result_record(i).failed;
+			}
+			return failed;
+		}
+		inline unsigned sharded_section::num_passed() const {
+			return num_tests() - num_failed();
+		}
+
+		inline std::ostream &sharded_section::print(std::ostream &stream,
+		                                            const char *test_root) const {
+			const char *name = shard(0).name;
+			stream << "[----------] " << num_tests() << " tests from " << name << std::endl;
+			for (unsigned i = 0; i < num_tests(); ++i) {
+				print_result_with(stream, test_root, i, result_record(i).tries);
+			}
+			stream << "[----------] " << num_tests() << " tests from " << name
+			       << " (0 ms total)" << std::endl;
+			return stream;
+		}
+
+		inline std::ostream &sharded_section::write_regressions(std::ostream &stream,
+		                                                        const char *test_root) const {
+			for (unsigned i = 0; i < count; ++i) {
+				shard(i).write_regressions(stream, test_root);
+			}
+			return stream;
+		}
+
+		template <typename Func>
+		void for_each_registered(Func func) {
+			for (auto entry = registry_begin; entry != registry_end; ++entry) {
+				// the msvc linker may pad its sections with zeroes
+				if (*entry != nullptr) {
+					func(**entry);
+				}
+			}
+		}
+
+		inline unsigned registry::num_tests() const {
+			unsigned tests = 0;
+			for_each_registered([&](const section_base &section) { tests += section.num_tests(); });
+			return tests;
+		}
+		inline unsigned registry::num_passed() const {
+			unsigned passed = 0;
+			for_each_registered(
+			        [&](const section_base &section) { passed += section.num_passed(); });
+			return passed;
+		}
+		inline unsigned registry::num_failed() const {
+			unsigned failed = 0;
+			for_each_registered(
+			        [&](const section_base &section) { failed += section.num_failed(); });
+			return failed;
+		}
+
+		inline std::ostream &registry::print(std::ostream &stream, const char *test_root) const {
+			for_each_registered(
+			        [&](const section_base &section) { section.print(stream, test_root); });
+			return stream;
+		}
+
+		inline std::ostream &registry::write_regressions(std::ostream &stream,
+		                                                 const char *test_root) const {
+			for_each_registered([&](const section_base &section) {
+				section.write_regressions(stream, test_root);
+			});
+			return stream;
+		}
+
+		inline void registry::store(const char *cache_dir) const {
+			for_each_registered([&](const section_base &section) { section.store(cache_dir); });
+		}
+
+		// the registry is not sharded itself, only the sections in it can be
+		inline test_record registry::result_record(unsigned) const {
+			return {false, {}};
+		}
+
+		inline std::ostream &registry::print_result_with(std::ostream &stream, const char *,
+		                                                 unsigned, const try_record &) const {
+			return stream;
+		}
+
+		/// add the lines to the header at path, unless it has them already; the header is only
+		/// written when it changes, so it does not trigger a rebuild for nothing
+		inline void append_regressions(const char *path, const std::string &lines) {
+			std::string contents;
+			{
+				std::ifstream file{path};
+				std::stringstream buffer;
+				buffer << file.rdbuf();
+				contents = buffer.str();
+			}
+			std::string added;
+			std::istringstream new_lines{lines};
+			for (std::string line; std::getline(new_lines, line);) {
+				if (contents.find(line) == std::string::npos &&
+				    added.find(line) == std::string::npos) {
+					added.append(line).append("\n");
+				}
+			}
+			if (added.empty()) {
+				return;
+			}
+			std::ofstream file{path, std::ios::app};
+			if (contents.empty()) {
+				file << "// failures found by metacheck, replayed before the random tries"
+				     << std::endl;
+			}
+			file << added;
+		}
+
+		/// a section of which the items are collected at run time, for the tests and sections
+		/// that are passed to test_all
+		class owned_section : public section_result {
+			std::vector<section_item> storage;
+			std::vector<std::unique_ptr<owned_section>> nested;
+
+		public:
+			owned_section(const char *name, std::vector<section_item> &&storage,
+			              std::vector<std::unique_ptr<owned_section>> &&nested)
+			    : section_result{name, nullptr, 0}, storage{std::move(storage)},
+			      nested{std::move(nested)} {
+				items = this->storage.data();
+				count = this->storage.size();
+			}
+		};
+
+		template <uint64_t patterns, typename Tests>
+		std::unique_ptr<owned_section> make_owned_section(const char *name, const Tests tests,
+		                                                  const std::string &path);
+
+		/// collects the items of a section that is passed to test_all; the tests are checked
+		/// while compiling all the same, only the sections are put together at run time
+		template <uint64_t patterns>
+		struct owned_items {
+			/// the full name of the section, as its tests are printed
+			std::string path;
+			std::vector<section_item> items;
+			std::vector<std::unique_ptr<owned_section>> nested;
+
+			/// the key of the section for its regressions
+			uint64_t key() const {
+				return section_key(name_hash({path.c_str(), 0, unsigned(path.size())}));
+			}
+
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename... Params>
+			void operator()(const test<Config, Func, tries, Params...>) {
+				items.push_back(item_in_section<test_in_sections<
+				                        selected<Func>(patterns) &&
+				                                reproduced(test_id<
+				                                           test<Config, Func, tries, Params...>>()),
+				                        Config, Func, tries, Params...>>::f(key()));
+			}
+
+			template <typename Config, typename Prop, unsigned tries, typename... Gens>
+			void operator()(const ctest<Config, Prop, tries, Gens...>) {
+				items.push_back(item_in_section<ctest_in_sections<
+				                        cselected<Prop>(patterns) &&
+				                                reproduced(test_id<
+				                                           ctest<Config, Prop, tries, Gens...>>()),
+				                        Config, Prop, tries, Gens...>>::f(key()));
+			}
+
+			template <typename... Tests>
+			void operator()(const section<Tests...> section) {
+				nested.push_back(make_owned_section<unknown_section_patterns()>(
+				        section.name, section.tests,
+				        path.empty() ? section.name : path + "." + section.name));
+				items.push_back({nullptr, nested.back().get()});
+			}
+
+			void operator()(const section_base *section) {
+				items.push_back({nullptr, section});
+			}
+		};
+
+		template <uint64_t patterns, typename Tests>
+		std::unique_ptr<owned_section> make_owned_section(const char *name, const Tests tests,
+		                                                  const std::string &path) {
+			owned_items<patterns> collected{path, {}, {}};
+			foreach
+				<void>(tests, [&](auto item) { collected(item); });
+			return std::make_unique<owned_section>(name, std::move(collected.items),
+			                                       std::move(collected.nested));
+		}
+
+		struct result_printer {
+			std::unique_ptr<owned_section> result;
+
+			operator int() const {
+				return result->num_failed() == 0 ? 0 : 1;
+			}
+		};
+
+		inline std::ostream &operator<<(std::ostream &stream, const result_printer &printer) {
+			const section_result &result = *printer.result;
+			std::size_t num_suites = result.count, num_tests = result.num_tests();
+
+			stream << "[==========] Running " << num_tests << (num_tests == 1 ? " test" : " tests")
+			       << " from " << num_suites << " test "
+			       << (num_suites == 1 ? "case." : "cases.") << std::endl
+			       << "Seed: " << random_seed::key << std::endl;
+			std::string root;
+			for (unsigned i = 0; i < result.count; ++i) {
+				if (!is_skipped(result.items[i])) {
+					print_item(stream, root, result.items[i], item_record(result.items[i]).tries);
+				}
+			}
+			stream << std::endl
+			       << "[----------] Global test environment tear-down" << std::endl
+			       << "[==========] " << num_tests << (num_tests == 1 ? " test" : " tests")
+			       << " from " << num_suites << " test " << (num_suites == 1 ? "case" : "cases")
+			       << " ran. (0 ms total)" << std::endl
+			       << "[  PASSED  ] " << result.num_passed() << " tests." << std::endl;
+			return stream;
+		}
+	} // namespace detail
+
+	template <typename... Tests>
+	detail::result_printer test_all(const Tests... tests) {
+		return {detail::make_owned_section<detail::unknown_section_patterns()>(
+		        "", std::make_tuple(tests...), "")};
+	}
+
+	/// keep the result of test_all for the next builds: add its failures to the regression
+	/// header, so they are replayed, and store the tested sections in the result cache; call it
+	/// once per run, printing the result writes nothing
+	inline void record_results(const detail::result_printer &printer) {
+		const detail::section_result &result = *printer.result;
+#ifdef METACHECK_REGRESSIONS
+		std::ostringstream failures;
+		for (unsigned i = 0; i < result.count; ++i) {
+			if (!detail::is_skipped(result.items[i])) {
+				detail::write_item_regressions(failures, "", result.items[i]);
+			}
+		}
+		detail::append_regressions(METACHECK_REGRESSIONS, failures.str());
+#endif
+#ifdef METACHECK_RESULT_CACHE
+		for (unsigned i = 0; i < result.count; ++i) {
+			if (result.items[i].section != nullptr) {
+				result.items[i].section->store(METACHECK_RESULT_CACHE);
+			}
+		}
+#endif
+#if !defined(METACHECK_REGRESSIONS) && !defined(METACHECK_RESULT_CACHE)
+		static_cast<void>(result);
+#endif
+	}
+} // namespace mc
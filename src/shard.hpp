@@ -0,0 +1,29 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the tries of the tests in a translation unit can be split over METACHECK_SHARDS translation
+// units, which are compiled in parallel; shard METACHECK_SHARD runs its own range of the tries of
+// every test, from the same seed, and a sharded_section merges the results of all the shards
+#pragma once
+
+#include <cstdint>
+
+#ifndef METACHECK_SHARDS
+#define METACHECK_SHARDS 1
+#endif
+#ifndef METACHECK_SHARD
+#define METACHECK_SHARD 0
+#endif
+
+static_assert(METACHECK_SHARD < METACHECK_SHARDS, "METACHECK_SHARD is not below METACHECK_SHARDS");
+
+namespace mc {
+	namespace detail {
+		/// the first try of a shard, out of a test with the given number of tries
+		constexpr unsigned shard_begin(unsigned tries, unsigned shard) {
+			return uint64_t(tries) * shard / METACHECK_SHARDS;
+		}
+	} // namespace detail
+} // namespace mc
@@ -0,0 +1,265 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compile only fail-fast checking, for when only a yes or no answer is needed:
+//
+//   METACHECK_STATIC_CHECK(section);
+//
+// checks the tests of the section in order while compiling, and turns the first failing test into a
+// static_assert; the tests after it are not instantiated at all, and neither are the tries after
+// the first failing one, apart from the rest of its block. nothing of the reporting is included, so
+// it needs neither <iostream> nor RTTI. the counterexample is only shrunk when
+// METACHECK_STATIC_SHRINK is defined, otherwise the failing try is reported as it was generated
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core.hpp"
+#include "ctest.hpp"
+#include "filter.hpp"
+
+namespace mc {
+	namespace detail {
+		/// fails the compilation; the failing test, its id, seed and try, and the parameters of
+		/// the counterexample are the arguments of this template in the error
+		template <template <typename...> class Func, uint64_t id, uint64_t seed,
+		          unsigned try_num, typename... Params>
+		struct static_failure {
+			static_assert(mpl::always_false<Params...>,
+			              "metacheck: a test failed, see the arguments of "
+			              "mc::detail::static_failure for the test, its id and seed, the failing "
+			              "try and the parameters");
+
+			constexpr static bool value = false;
+		};
+
+		/// fails the compilation for a constexpr test; its values can not be template arguments,
+		/// so only the test, its id and seed and the failing try are
+		template <typename Prop, uint64_t id, uint64_t seed, unsigned try_num>
+		struct static_cfailure {
+			static_assert(mpl::always_false<Prop>,
+			              "metacheck: a constexpr test failed, see the arguments of "
+			              "mc::detail::static_cfailure for the test, its id and seed and the "
+			              "failing try");
+
+			constexpr static bool value = false;
+		};
+
+		template <template <typename...> class Func, uint64_t id, uint64_t seed,
+		          unsigned try_num, typename Params>
+		struct static_failure_of;
+		template <template <typename...> class Func, uint64_t id, uint64_t seed,
+		          unsigned try_num, typename... Params>
+		struct static_failure_of<Func, id, seed, try_num, gen::value::list<Params...>> {
+			using type = static_failure<Func, id, seed, try_num, typename Params::type...>;
+		};
+
+#ifdef METACHECK_STATIC_SHRINK
+		template <typename Config, template <typename...> class Func, typename Params>
+		using static_counterexample = typename shrink_all<Config, Func, Params>::type::parameters;
+#else
+		template <typename Config, template <typename...> class Func, typename Params>
+		using static_counterexample = Params;
+#endif
+
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, unsigned first, typename Tries, typename... Params>
+		struct static_check_tries;
+
+		/// what follows a block of tries from first on, of which the try first + failed failed
+		/// or none did
+		template <bool failed, bool last>
+		struct static_check_next;
+		template <bool last>
+		struct static_check_next<true, last> {
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename seed, unsigned first, unsigned size, unsigned failed,
+			          typename... Params>
+			using f = typename static_failure_of<
+			        Func, test_id<test<Config, Func, tries, Params...>>(), seed::key,
+			        first + failed,
+			        static_counterexample<Config, Func,
+			                              typename call_generated<
+			                                      Func,
+			                                      try_seed<Config, seed, first + failed, tries>,
+			                                      Params...>::parameters>>::type;
+		};
+		template <>
+		struct static_check_next<false, true> {
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename seed, unsigned first, unsigned size, unsigned failed,
+			          typename... Params>
+			using f = std::true_type;
+		};
+		template <>
+		struct static_check_next<false, false> {
+			// the next block is twice as large, up to the last try
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename seed, unsigned first, unsigned size, unsigned failed,
+			          typename... Params>
+			using f = static_check_tries<
+			        Config, Func, tries, seed, first + size,
+			        std::make_index_sequence<min_of({size * 2, tries - first - size})>, Params...>;
+		};
+
+		/// run the tries of a test from first on in blocks that double in size, each block in a
+		/// single pack expansion like check_tries does; the blocks after the first failing try
+		/// are not instantiated, so at most about twice the tries up to it are
+		template <typename Config, template <typename...> class Func, unsigned tries,
+		          typename seed, unsigned first, std::size_t... Tries, typename... Params>
+		struct static_check_tries<Config, Func, tries, seed, first, std::index_sequence<Tries...>,
+		                          Params...> {
+			constexpr static unsigned size   = sizeof...(Tries);
+			constexpr static unsigned failed = first_failure(
+			        {call_generated<Func, try_seed<Config, seed, first + Tries, tries>,
+			                        Params...>::result::value...});
+
+			constexpr static bool value =
+			        static_check_next<(failed < size), (first + size >= tries)>::template f<
+			                Config, Func, tries, seed, first, size, failed, Params...>::value;
+		};
+
+		template <bool selected>
+		struct static_test {
+			// the test is left out by the test filter
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename... Params>
+			using f = std::true_type;
+		};
+		template <>
+		struct static_test<true> {
+			template <typename Config, template <typename...> class Func, unsigned tries,
+			          typename... Params>
+			using f = static_check_tries<Config, Func, tries,
+			                             test_seed<test<Config, Func, tries, Params...>>, 0,
+			                             std::make_index_sequence<(tries > 0 ? 1 : 0)>,
+			                             Params...>;
+		};
+
+		template <bool failed>
+		struct static_ccheck_impl {
+			template <typename Prop, uint64_t id, uint64_t seed, unsigned try_num>
+			using f = std::true_type;
+		};
+		template <>
+		struct static_ccheck_impl<true> {
+			template <typename Prop, uint64_t id, uint64_t seed, unsigned try_num>
+			using f = static_cfailure<Prop, id, seed, try_num>;
+		};
+
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first>
+		struct static_ctries;
+
+		template <bool next>
+		struct static_cnext {
+			// a try of the block failed, or it was the last block
+			template <typename Config, typename Prop, typename Params, uint64_t key,
+			          unsigned tries, unsigned first>
+			using f = std::integral_constant<unsigned, 0>;
+		};
+		template <>
+		struct static_cnext<true> {
+			template <typename Config, typename Prop, typename Params, uint64_t key,
+			          unsigned tries, unsigned first>
+			using f = static_ctries<Config, Prop, Params, key, tries, first>;
+		};
+
+		/// the first failing try of a constexpr test from first on, counted from 1, or 0 when
+		/// none fails; the tries run in blocks like ctries does, and the blocks after the one
+		/// with the failing try are not instantiated
+		template <typename Config, typename Prop, typename Params, uint64_t key, unsigned tries,
+		          unsigned first>
+		struct static_ctries {
+			constexpr static unsigned last = min_of({tries, first + ctest_block});
+			constexpr static unsigned failnum =
+			        ctries_block<Config, Prop, Params, key, tries, first, last>::value.failnum;
+
+			constexpr static unsigned value =
+			        failnum + static_cnext<(failnum == 0 && last < tries)>::template f<
+			                          Config, Prop, Params, key, tries, last>::value;
+		};
+
+		/// run the tries of a constexpr test up to the first one that fails; the counterexample
+		/// is not shrunk, since only its seed and try are reported
+		template <typename Config, typename Prop, unsigned tries, typename... Gens>
+		struct static_ccheck {
+			constexpr static uint64_t key = test_seed<ctest<Config, Prop, tries, Gens...>>::key;
+			constexpr static unsigned failnum =
+			        static_ctries<Config, Prop, cparams<Gens...>, key, tries, 0>::value;
+
+			constexpr static bool value = static_ccheck_impl<(failnum != 0)>::template f<
+			        Prop, test_id<ctest<Config, Prop, tries, Gens...>>(), key, failnum - 1>::value;
+		};
+
+		template <bool selected>
+		struct static_ctest {
+			// the test is left out by the test filter
+			template <typename Config, typename Prop, unsigned tries, typename... Gens>
+			using f = std::true_type;
+		};
+		template <>
+		struct static_ctest<true> {
+			template <typename Config, typename Prop, unsigned tries, typename... Gens>
+			using f = static_ccheck<Config, Prop, tries, Gens...>;
+		};
+
+		template <uint64_t patterns, typename... Tests>
+		struct static_all;
+
+		/// whether a single item of a section passes
+		template <uint64_t patterns, typename Test>
+		struct static_item;
+		template <uint64_t patterns, typename Config, template <typename...> class Func,
+		          unsigned tries, typename... Params>
+		struct static_item<patterns, test<Config, Func, tries, Params...>>
+		        : static_test<selected<Func>(patterns) &&
+		                      reproduced(test_id<test<Config, Func, tries, Params...>>())>::
+		                  template f<Config, Func, tries, Params...> {};
+		template <uint64_t patterns, typename Config, typename Prop, unsigned tries,
+		          typename... Gens>
+		struct static_item<patterns, ctest<Config, Prop, tries, Gens...>>
+		        : static_ctest<cselected<Prop>(patterns) &&
+		                       reproduced(test_id<ctest<Config, Prop, tries, Gens...>>())>::
+		                  template f<Config, Prop, tries, Gens...> {};
+		template <uint64_t patterns, typename... Tests>
+		struct static_item<patterns, section<Tests...>>
+		        : static_all<unknown_section_patterns(), Tests...> {};
+
+		template <bool passed>
+		struct static_next {
+			// stop at the first failure, without instantiating the tests after it
+			template <uint64_t patterns, typename... Tests>
+			using f = std::false_type;
+		};
+		template <>
+		struct static_next<true> {
+			template <uint64_t patterns, typename... Tests>
+			using f = static_all<patterns, Tests...>;
+		};
+
+		/// check the tests in order, up to the first one that fails
+		template <uint64_t patterns, typename... Tests>
+		struct static_all : std::true_type {};
+		template <uint64_t patterns, typename Test, typename... Tests>
+		struct static_all<patterns, Test, Tests...>
+		        : static_next<static_item<patterns, Test>::value>::template f<patterns,
+		                                                                      Tests...> {};
+
+		template <uint64_t patterns, typename Tests>
+		struct static_check;
+		template <uint64_t patterns, typename... Tests>
+		struct static_check<patterns, std::tuple<Tests...>> : static_all<patterns, Tests...> {};
+	} // namespace detail
+} // namespace mc
+
+// check all the tests of SECTION while compiling, and fail at the first test that fails
+#define METACHECK_STATIC_CHECK(SECTION)                                                       \
+    static_assert(mc::detail::static_check<mc::detail::section_patterns(SECTION.name),         \
+                                           std::remove_cv_t<decltype(SECTION.tests)>>::value, \
+                  "metacheck: a test of " #SECTION " failed")
@@ -0,0 +1,80 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the printable names of types, taken from the signature of a function at compile time like the
+// names of the tests in filter.hpp; they need neither RTTI nor a demangler, so the names of the
+// parameters of a test are constants in the translation unit of the test
+#pragma once
+
+#include <string>
+
+#include "filter.hpp"
+
+namespace mc {
+	namespace detail {
+		template <typename T>
+		constexpr const char *pretty_type() {
+#ifdef _MSC_VER
+			return __FUNCSIG__;
+#else
+			return __PRETTY_FUNCTION__;
+#endif
+		}
+
+		/// the name of T
+		template <typename T>
+		constexpr string_part type_name() {
+			const char *str = pretty_type<T>();
+			unsigned end    = string_length(str);
+#ifdef _MSC_VER
+			// "const char *__cdecl mc::detail::pretty_type<ns::T>(void)"
+			while (str[end] != '>') {
+				--end;
+			}
+			unsigned begin = 0;
+			while (str[begin] != '<') {
+				++begin;
+			}
+			return {str, begin + 1, end};
+#else
+			// "constexpr const char* mc::detail::pretty_type() [with T = ns::T]"
+			while (str[end] != ']') {
+				--end;
+			}
+			unsigned begin = 0;
+			while (str[begin] != '=') {
+				++begin;
+			}
+			return {str, begin + 2, end};
+#endif
+		}
+
+		/// the names of the types, followed by an empty name so the array is never empty
+		template <typename... Ts>
+		struct type_names {
+			constexpr static string_part value[] = {type_name<Ts>()..., {nullptr, 0, 0}};
+		};
+		template <typename... Ts>
+		constexpr string_part type_names<Ts...>::value[];
+	} // namespace detail
+
+	/// the name of T, as a string
+	template <typename T>
+	struct type_name {
+		operator std::string() const {
+			detail::string_part name = detail::type_name<T>();
+			return {name.str + name.begin, name.end - name.begin};
+		}
+	};
+
+	/// the unqualified name of F, as a string
+	template <template <typename...> class F>
+	struct func_name {
+		operator std::string() const {
+			detail::string_part name = detail::test_name<F>();
+			return {name.str + name.begin, name.end - name.begin};
+		}
+	};
+} // namespace mc
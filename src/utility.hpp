@@ -4,65 +4,39 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 #pragma once
 
+#include <initializer_list>
+#include <limits>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <kvasir/mpl/mpl.hpp>
 
-#include <string>
-#include <typeinfo>
-
-#ifdef __GNUG__
-#include <cxxabi.h>
-
-#endif
-
 namespace mc {
-#ifdef __GNUG__
-
-	template <typename T>
-	struct type_name {
-		operator std::string() const {
-			const char *name{
-			        __cxxabiv1::__cxa_demangle(typeid(T).name(), nullptr, nullptr, nullptr)};
-			std::string res{name}; // copy from name into string
-			delete name;
-			return res;
-		}
-	};
-
-	template <template <typename...> class F>
-	struct func_name {
-		operator std::string() const {
-			std::string name{type_name<func_name<F>>{}};
-			std::size_t pos = name.rfind("::");
-			if (pos != name.npos) {
-				name.erase(0, pos + 2);
-			} else {
-				name.erase(0, 14); // remove "mc::func_name<"
+	namespace detail {
+		constexpr unsigned sum(std::initializer_list<unsigned> values) {
+			unsigned total = 0;
+			for (unsigned value : values) {
+				total += value;
 			}
-			name.pop_back(); // remove trailing '>'
-			return name;
+			return total;
 		}
-	};
-
-#else
 
-	template <typename T>
-	struct type_name {
-		operator std::string() const {
-			return {typeid(T).name()};
+		constexpr unsigned min_of(std::initializer_list<unsigned> values) {
+			unsigned min = std::numeric_limits<unsigned>::max();
+			for (unsigned value : values) {
+				min = value < min ? value : min;
+			}
+			return min;
 		}
-	};
 
-	template <template <typename...> class F>
-	struct func_name {
-		operator std::string() const {
-			return {typeid(func_name<F>).name()};
+		constexpr unsigned max_of(std::initializer_list<unsigned> values) {
+			unsigned max = 0;
+			for (unsigned value : values) {
+				max = value > max ? value : max;
+			}
+			return max;
 		}
-	};
-#endif
 
-	namespace detail {
 		template <typename Out>
 		struct foreach_impl {
 			template <typename List, typename Func, std::size_t... Ints>
@@ -367,6 +341,7 @@ namespace mc {
 			};
 		} // namespace detail
 
+		/// fold F over the Ts starting from State, and call C with the state after every element
 		template <typename State, typename F, typename C>
 		struct fold_transform {
 			template <typename... Ts>
@@ -391,5 +366,11 @@ namespace mc {
 		/// reversed function call sequence gives equal results
 		template <template <typename...> class F1, template <typename...> class F2, typename L>
 		using associative = mpl::equal<F1<F2<L>>, F2<F1<L>>>;
+
+		/// two implementations of a function give equal results, for instance a rewrite that
+		/// should be faster to compile; the result of a failure names both results
+		template <template <typename...> class F, template <typename...> class G, typename... Ts>
+		using equivalent = mpl::equal<mpl::call<F, kvasir::mpl::list<Ts...>>,
+		                              mpl::call<G, kvasir::mpl::list<Ts...>>>;
 	} // namespace prop
 } // namespace mc
@@ -0,0 +1,40 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// times copying tuples of generated layouts at run time, see src/benchmark.hpp
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/benchmark.hpp"
+
+namespace benchns {
+	/// copies a vector of tuples of the generated types
+	template <typename List>
+	struct copy_tuples;
+	template <typename... Ts>
+	struct copy_tuples<kvasir::mpl::list<Ts...>> {
+		std::size_t operator()() const {
+			std::vector<std::tuple<Ts...>> from(256), to;
+			to = from;
+			return to.size() * sizeof(std::tuple<Ts...>);
+		}
+	};
+
+	using member = mc::gen::any<mc::gen::just<char>, mc::gen::just<int>, mc::gen::just<double>,
+	                            mc::gen::just<long double>, mc::gen::just<std::string>>;
+} // namespace benchns
+
+constexpr auto benchmark_section = mc::section(
+        "tuples",
+        mc::benchmark<benchns::copy_tuples, 50,
+                      mc::gen::list_of<benchns::member, mc::gen::uint_<16>>>);
+
+int main() {
+	std::cout << mc::run_benchmarks(benchmark_section);
+	return 0;
+}
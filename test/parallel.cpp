@@ -0,0 +1,31 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// runs the constexpr tests of the test section at run time, see src/parallel.hpp:
+//
+//   metacheck_parallel [tries [threads]]
+#include <cstdlib>
+#include <iostream>
+
+#include "../src/parallel.hpp"
+#include "test.hpp"
+
+#ifndef METACHECK_PARALLEL_TRIES
+#define METACHECK_PARALLEL_TRIES 1000000
+#endif
+
+int main(int argc, char **argv) {
+	mc::parallel_config config{METACHECK_PARALLEL_TRIES};
+	if (argc > 1) {
+		config.tries = std::strtoull(argv[1], nullptr, 10);
+	}
+	if (argc > 2) {
+		config.threads = unsigned(std::strtoul(argv[2], nullptr, 10));
+	}
+	auto result = mc::test_parallel(config, test_section);
+	std::cout << result;
+	mc::record_results(result);
+	return result;
+}
@@ -0,0 +1,71 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// a failure of the parallel runner after round 0 reproduces while compiling, see src/parallel.hpp;
+// the test only passes the value of the single try of round 0, so its first failure is the try of
+// round 1
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../src/parallel.hpp"
+
+namespace testns {
+	/// passes only the value that round 0 generates
+	struct only_round_zero {
+		constexpr bool operator()(unsigned value) const;
+	};
+
+	using rounds_gen  = mc::cgen::uint_<1000000000>;
+	using rounds_test = mc::detail::ctest<mc::config<>, only_round_zero, 1, rounds_gen>;
+	using params      = mc::detail::cparams<rounds_gen>;
+
+	constexpr bool only_round_zero::operator()(unsigned value) const {
+		return value == mc::detail::generate_try<mc::config<>, params>(
+		                        mc::detail::test_seed<rounds_test>::key, 0, 1)
+		                        .head;
+	}
+
+	constexpr uint64_t round_one = mc::detail::round_key(mc::detail::test_seed<rounds_test>::key, 1);
+
+	// what -DMETACHECK_REPRODUCE_SEED=<round_one> -DMETACHECK_REPRODUCE_TRY=0 compiles
+	using reproduced = mc::detail::ctries<mc::config<>, only_round_zero, params, round_one, 1, 0, 1>;
+	static_assert(reproduced::value.failed && reproduced::value.failnum == 1,
+	              "the try of round 1 fails while compiling");
+	constexpr mc::detail::cresult<params> shrunk =
+	        mc::detail::cshrink<mc::config<>, only_round_zero>(reproduced::value);
+} // namespace testns
+
+int main() {
+	mc::detail::parallel_result run =
+	        mc::detail::run_parallel<mc::config<>, testns::only_round_zero, 1, testns::rounds_gen>(
+	                mc::parallel_config{4, 2});
+
+	std::ostringstream reproduce;
+	reproduce << "Reproduce: -DMETACHECK_REPRODUCE=rounds.only_round_zero"
+	          << " -DMETACHECK_REPRODUCE_ID=" << mc::detail::test_id<testns::rounds_test>()
+	          << " -DMETACHECK_REPRODUCE_SEED=" << testns::round_one
+	          << " -DMETACHECK_REPRODUCE_TRY=0";
+	std::ostringstream counterexample;
+	counterexample << testns::shrunk.params.head;
+	std::ostringstream printed;
+	mc::detail::print_parallel(printed, "rounds.", run);
+	std::cout << printed.str();
+
+	bool passed = run.failnum == 2 && run.round == 1 && run.report.failnum == 1 &&
+	              run.report.test_key == testns::round_one &&
+	              run.report.shrinks == testns::shrunk.shrinks &&
+	              run.text == counterexample.str() &&
+	              printed.str().find("Failure after 2/4 tries, at try 0 of round 1,") !=
+	                      std::string::npos &&
+	              printed.str().find(reproduce.str()) != std::string::npos;
+	if (!passed) {
+		std::cout << "the failure of round 1 does not match its reproduction:" << std::endl
+		          << reproduce.str() << std::endl
+		          << "Parameters: " << counterexample.str() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,11 @@
+//          Copyright Chiel Douwes 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE.md or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the compile only check of the test sections, see src/static_check.hpp
+#include "../src/static_check.hpp"
+#include "test.hpp"
+
+METACHECK_STATIC_CHECK(test_section);
+METACHECK_STATIC_CHECK(precalc_test_section);
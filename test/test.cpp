@@ -3,7 +3,7 @@
 //    (See accompanying file LICENSE.md or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include "../src/metacheck.hpp"
 #include "test.hpp"
 
-constexpr auto test_section_result                = PRECALC_SECTION(precalc_test_section);
-const mc::detail::section_base *test_section_base = &test_section_result;
+METACHECK_REGISTER_SECTION(test_section_base, precalc_test_section);
@@ -3,7 +3,8 @@
 //    (See accompanying file LICENSE.md or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
-#include "../src/metacheck.hpp"
+#include "../src/core.hpp"
+#include "../src/ctest.hpp"
 
 namespace mpl = kvasir::mpl;
 
@@ -29,13 +30,68 @@ namespace testns {
 
 	template <typename L>
 	using reverse_test = std::is_same<L, reverse<L>>;
+
+	/// the reverse of kvasir mpl, which reverses the whole pack at once instead of recursing on
+	/// every element
+	template <typename L>
+	struct fast_reverse_impl;
+	template <template <typename...> class Seq, typename... Ts>
+	struct fast_reverse_impl<Seq<Ts...>> {
+		using f = mpl::call<mpl::reverse<mpl::cfe<Seq>>, Ts...>;
+	};
+
+	template <typename L>
+	using fast_reverse = typename fast_reverse_impl<L>::f;
+
+	/// the rewrite gives the same results as the original
+	template <typename L>
+	using fast_reverse_test = mc::prop::equivalent<reverse, fast_reverse, L>;
+
+	template <unsigned capacity>
+	constexpr mc::carray<int, capacity> insertion_sort(mc::carray<int, capacity> values) {
+		for (unsigned i = 1; i < values.size(); ++i) {
+			for (unsigned j = i; j > 0 && values[j] < values[j - 1]; --j) {
+				int swapped   = values[j];
+				values[j]     = values[j - 1];
+				values[j - 1] = swapped;
+			}
+		}
+		return values;
+	}
+
+	/// a sorted array is in order and has the same sum
+	struct sort_test {
+		template <unsigned capacity>
+		constexpr bool operator()(mc::carray<int, capacity> values) const {
+			mc::carray<int, capacity> sorted = insertion_sort(values);
+			int sum                          = 0;
+			for (unsigned i = 0; i < values.size(); ++i) {
+				sum += values[i] - sorted[i];
+			}
+			for (unsigned i = 1; i < sorted.size(); ++i) {
+				if (sorted[i] < sorted[i - 1]) {
+					return false;
+				}
+			}
+			return sum == 0;
+		}
+	};
 } // namespace testns
 
 constexpr auto test_section = mc::section(
-        "main", mc::test<testns::reverse_test, // the function to test, should return a bool
-                         10, // the number of times to repeat the test
-                         // parameters to use in the test
-                         mc::gen::list_of<mc::gen::anything>>);
+        "main",
+        mc::test<testns::reverse_test, // the function to test, should return a bool
+                 10,                   // the number of times to repeat the test
+                 // parameters to use in the test
+                 mc::gen::list_of<mc::gen::anything>>,
+        // the same test with a limit on how far a failure is shrunk
+        mc::test_with<mc::config<mc::max_shrinks<2>, mc::max_candidates<64>>,
+                      testns::reverse_test, 10, mc::gen::list_of<mc::gen::anything>>,
+        // two implementations of the same function compared on the same lists
+        mc::test<testns::fast_reverse_test, 10, mc::gen::list_of<mc::gen::anything>>,
+        // a constexpr function tested by constexpr evaluation, a thousand tries cost a few
+        // template instantiations
+        mc::ctest<testns::sort_test, 1000, mc::cgen::array_of<mc::cgen::int_<>, 16>>);
 
 constexpr auto precalc_test_section =
         mc::section("precalc_main",
@@ -43,4 +99,3 @@ constexpr auto precalc_test_section =
                              10, // the number of times to repeat the test
                              // parameters to use in the test
                              mc::gen::list_of<mc::gen::anything>>);
-extern const mc::detail::section_base *test_section_base;